@@ -0,0 +1,441 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ngl-pokepaste/file.hpp"
+#include "ngl-pokepaste/pokepaste.hpp"
+#include "ngl-pokepaste/synthetic.hpp"
+
+// Every allocation made through the global operator new is counted, so each benchmark can report
+// how many allocations one operation costs
+namespace {
+std::atomic<std::uint64_t> allocation_count{0};
+} // namespace
+
+void *operator new(std::size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size == 0 ? 1 : size)) { // NOLINT(cppcoreguidelines-no-malloc)
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+void *operator new[](std::size_t size) {
+  return ::operator new(size);
+}
+
+// Once this is inlined next to the operator new above, GCC takes the free for a mismatched delete,
+// not knowing that operator new hands out malloc'd memory
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void *ptr) noexcept {
+  std::free(ptr); // NOLINT(cppcoreguidelines-no-malloc)
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+void operator delete[](void *ptr) noexcept {
+  ::operator delete(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  ::operator delete(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+  ::operator delete(ptr);
+}
+
+namespace {
+
+// Keeps the optimiser from discarding a result that is otherwise unused
+template <typename T>
+void keep(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void *sink = nullptr;
+  sink                             = &value;
+#endif
+}
+
+struct Corpus {
+  std::string name;
+  std::vector<std::string> pastes;
+
+  [[nodiscard]] std::size_t bytes() const {
+    std::size_t out = 0;
+    for (const auto &paste : pastes) {
+      out += paste.size();
+    }
+    return out;
+  }
+};
+
+struct Result {
+  std::string name;
+  std::string corpus;
+  std::uint64_t ops    = 0;
+  double ns_per_op     = 0;
+  double mb_per_s      = 0;
+  double allocs_per_op = 0;
+};
+
+struct Options {
+  std::filesystem::path resources = "resources";
+  std::chrono::milliseconds min_time{200};
+  std::string filter;
+  std::uint64_t seed          = 0;
+  std::size_t synthetic_bytes = std::size_t{1} << 20U;
+};
+
+// Runs fn, which performs ops operations over bytes of input, in doubling batches until min_time has
+// passed, so the clock is read rarely enough not to distort the cheapest operations
+template <typename Fn>
+[[nodiscard]] Result measure(std::string name, const std::string &corpus, std::size_t ops, std::size_t bytes, std::chrono::nanoseconds min_time, Fn &&fn) {
+  using clock = std::chrono::steady_clock;
+  fn();
+
+  const auto allocations_before = allocation_count.load(std::memory_order_relaxed);
+  const auto start              = clock::now();
+  std::uint64_t calls           = 0;
+  auto elapsed                  = clock::duration{};
+  for (std::uint64_t batch = 1; elapsed < min_time; batch *= 2) {
+    for (std::uint64_t i = 0; i < batch; i++) {
+      fn();
+    }
+    calls += batch;
+    elapsed = clock::now() - start;
+  }
+  const auto allocations = allocation_count.load(std::memory_order_relaxed) - allocations_before;
+
+  const auto total_ops = calls * ops;
+  const auto seconds   = std::chrono::duration<double>(elapsed).count();
+  Result out;
+  out.name          = std::move(name);
+  out.corpus        = corpus;
+  out.ops           = total_ops;
+  out.ns_per_op     = (seconds * 1e9) / static_cast<double>(total_ops);
+  out.mb_per_s      = (static_cast<double>(bytes) * static_cast<double>(calls)) / seconds / 1e6;
+  out.allocs_per_op = static_cast<double>(allocations) / static_cast<double>(total_ops);
+  return out;
+}
+
+[[nodiscard]] Corpus load_resources(const std::filesystem::path &directory) {
+  Corpus out{"resources", {}};
+  for (const auto &[path, paste] : ngl::pokepaste::decode_pokepaste_directory(directory)) {
+    out.pastes.push_back(ngl::pokepaste::encode_pokepaste(paste));
+  }
+  return out;
+}
+
+[[nodiscard]] Corpus with_crlf(const Corpus &corpus) {
+  Corpus out{corpus.name + "-crlf", {}};
+  for (const auto &paste : corpus.pastes) {
+    auto &converted = out.pastes.emplace_back();
+    for (const auto c : paste) {
+      if (c == '\n') {
+        converted.push_back('\r');
+      }
+      converted.push_back(c);
+    }
+  }
+  return out;
+}
+
+[[nodiscard]] Corpus synthetic(std::string name, const ngl::pokepaste::synthetic::Options &generator_options, std::size_t min_bytes) {
+  Corpus out{std::move(name), {}};
+  ngl::pokepaste::synthetic::Generator generator{generator_options};
+  for (auto &paste : generator.corpus(min_bytes)) {
+    out.pastes.push_back(std::move(paste.text));
+  }
+  return out;
+}
+
+// Every paste of corpus joined into one
+[[nodiscard]] Corpus joined(const Corpus &corpus) {
+  Corpus out{corpus.name + "-joined", {""}};
+  auto &paste = out.pastes.front();
+  for (const auto &source : corpus.pastes) {
+    if (!paste.empty()) {
+      paste.append("\n\n");
+    }
+    paste.append(source);
+  }
+  return out;
+}
+
+void bench_pastes(const Corpus &corpus, const Options &options, std::vector<Result> &results) {
+  const auto bytes = corpus.bytes();
+  const auto count = corpus.pastes.size();
+  const auto run   = [&](std::string name, std::size_t run_bytes, auto &&fn) {
+    if (name.find(options.filter) != std::string::npos) {
+      results.push_back(measure(std::move(name), corpus.name, count, run_bytes, options.min_time, fn));
+    }
+  };
+
+  ngl::pokepaste::PokePaste decoded_into;
+  std::vector<ngl::pokepaste::PokePaste> decoded;
+  for (const auto &paste : corpus.pastes) {
+    decoded.push_back(ngl::pokepaste::decode_pokepaste(paste));
+  }
+
+  run("decode_pokepaste", bytes, [&] {
+    for (const auto &paste : corpus.pastes) {
+      keep(ngl::pokepaste::decode_pokepaste(paste));
+    }
+  });
+  run("decode_pokepaste_view", bytes, [&] {
+    for (const auto &paste : corpus.pastes) {
+      keep(ngl::pokepaste::decode_pokepaste_view(paste));
+    }
+  });
+  run("decode_pokepaste_into", bytes, [&] {
+    for (const auto &paste : corpus.pastes) {
+      ngl::pokepaste::decode_pokepaste_into(paste, decoded_into);
+      keep(decoded_into);
+    }
+  });
+
+  // Encoding is measured against the canonical text it produces, which CRLF input is longer than
+  std::size_t encoded_bytes = 0;
+  for (const auto &paste : decoded) {
+    encoded_bytes += ngl::pokepaste::encoded_size(paste);
+  }
+  run("encode_pokepaste", encoded_bytes, [&] {
+    for (const auto &paste : decoded) {
+      keep(ngl::pokepaste::encode_pokepaste(paste));
+    }
+  });
+  std::string encoded_into;
+  run("encode_pokepaste_to", encoded_bytes, [&] {
+    for (const auto &paste : decoded) {
+      encoded_into.clear();
+      ngl::pokepaste::encode_pokepaste_to(encoded_into, paste);
+      keep(encoded_into);
+    }
+  });
+  run("round_trip", bytes, [&] {
+    for (const auto &paste : corpus.pastes) {
+      keep(ngl::pokepaste::encode_pokepaste(ngl::pokepaste::decode_pokepaste(paste)));
+    }
+  });
+
+  // Measured against the binary size, so compare these with the text decoders per paste
+  std::vector<std::string> binary;
+  std::size_t binary_bytes = 0;
+  for (const auto &paste : decoded) {
+    binary_bytes += binary.emplace_back(ngl::pokepaste::encode_binary(paste)).size();
+  }
+  run("encode_binary", binary_bytes, [&] {
+    for (const auto &paste : decoded) {
+      keep(ngl::pokepaste::encode_binary(paste));
+    }
+  });
+  run("decode_binary", binary_bytes, [&] {
+    for (const auto &paste : binary) {
+      keep(ngl::pokepaste::decode_binary(paste));
+    }
+  });
+
+  // Likewise measured against the packed size
+  std::vector<std::string> packed;
+  std::size_t packed_bytes = 0;
+  for (const auto &paste : decoded) {
+    packed_bytes += packed.emplace_back(ngl::pokepaste::encode_packed(paste)).size();
+  }
+  run("encode_packed", packed_bytes, [&] {
+    for (const auto &paste : decoded) {
+      keep(ngl::pokepaste::encode_packed(paste));
+    }
+  });
+  run("decode_packed", packed_bytes, [&] {
+    for (const auto &paste : packed) {
+      keep(ngl::pokepaste::decode_packed(paste));
+    }
+  });
+}
+
+// Lines of every field in corpus, taken from its canonical encoding. Fields the corpus never uses
+// get a representative line so that every line decoder is still measured
+[[nodiscard]] std::map<ngl::pokepaste::FieldKind, std::vector<std::string>> collect_lines(const Corpus &corpus) {
+  using ngl::pokepaste::FieldKind;
+  std::map<FieldKind, std::vector<std::string>> out;
+  for (const auto &paste : corpus.pastes) {
+    for (const auto &pokemon : ngl::pokepaste::decode_pokepaste(paste)) {
+      const auto text   = ngl::pokepaste::encode_pokemon(pokemon);
+      std::size_t begin = 0;
+      for (bool first = true; begin <= text.size(); first = false) {
+        const auto end  = std::min(text.find('\n', begin), text.size());
+        const auto line = std::string_view{text}.substr(begin, end - begin);
+        const auto kind = first ? std::optional{FieldKind::Name} : ngl::pokepaste::detail::classify_line(line);
+        if (kind.has_value()) {
+          out[kind.value()].emplace_back(line);
+        }
+        begin = end + 1;
+      }
+    }
+  }
+
+  const std::pair<FieldKind, std::string_view> samples[] = {
+    {FieldKind::Name, "Nickname (Species) (F) @ Item"},
+    {FieldKind::Ability, "Ability: Ability"},
+    {FieldKind::Level, "Level: 50"},
+    {FieldKind::Shiny, "Shiny: Yes"},
+    {FieldKind::Happiness, "Happiness: 160"},
+    {FieldKind::DynamaxLevel, "Dynamax Level: 5"},
+    {FieldKind::Gigantamax, "Gigantamax: Yes"},
+    {FieldKind::TeraType, "Tera Type: Fairy"},
+    {FieldKind::EVs, "EVs: 252 HP / 4 Atk / 252 Spe"},
+    {FieldKind::Nature, "Jolly Nature"},
+    {FieldKind::IVs, "IVs: 0 Atk"},
+    {FieldKind::Move, "- Move"},
+  };
+  for (const auto &[kind, line] : samples) {
+    if (out[kind].empty()) {
+      out[kind].emplace_back(line);
+    }
+  }
+  return out;
+}
+
+template <typename Decode>
+void bench_line(std::string name, const Corpus &corpus, const std::vector<std::string> &lines, const Options &options, std::vector<Result> &results, Decode &&decode) {
+  if (name.find(options.filter) == std::string::npos) {
+    return;
+  }
+  std::size_t bytes = 0;
+  for (const auto &line : lines) {
+    bytes += line.size();
+  }
+  results.push_back(measure(std::move(name), corpus.name, lines.size(), bytes, options.min_time, [&] {
+    for (const auto &line : lines) {
+      keep(decode(line));
+    }
+  }));
+}
+
+void bench_lines(const Corpus &corpus, const Options &options, std::vector<Result> &results) {
+  namespace detail = ngl::pokepaste::detail;
+  using ngl::pokepaste::FieldKind;
+  auto lines = collect_lines(corpus);
+  bench_line("detail::decode_name_line", corpus, lines[FieldKind::Name], options, results, detail::decode_name_line);
+  bench_line("detail::decode_ability_line", corpus, lines[FieldKind::Ability], options, results, detail::decode_ability_line);
+  bench_line("detail::decode_level_line", corpus, lines[FieldKind::Level], options, results, detail::decode_level_line);
+  bench_line("detail::decode_shiny_line", corpus, lines[FieldKind::Shiny], options, results, detail::decode_shiny_line);
+  bench_line("detail::decode_happiness_line", corpus, lines[FieldKind::Happiness], options, results, detail::decode_happiness_line);
+  bench_line("detail::decode_dynamax_level_line", corpus, lines[FieldKind::DynamaxLevel], options, results, detail::decode_dynamax_level_line);
+  bench_line("detail::decode_gigantamax_line", corpus, lines[FieldKind::Gigantamax], options, results, detail::decode_gigantamax_line);
+  bench_line("detail::decode_tera_type_line", corpus, lines[FieldKind::TeraType], options, results, detail::decode_tera_type_line);
+  bench_line("detail::decode_evs_line", corpus, lines[FieldKind::EVs], options, results, detail::decode_evs_line);
+  bench_line("detail::decode_nature_line", corpus, lines[FieldKind::Nature], options, results, detail::decode_nature_line);
+  bench_line("detail::decode_ivs_line", corpus, lines[FieldKind::IVs], options, results, detail::decode_ivs_line);
+  bench_line("detail::decode_move_line", corpus, lines[FieldKind::Move], options, results, detail::decode_move_line);
+}
+
+void write_json_string(std::ostream &os, std::string_view text) {
+  os << '"';
+  for (const auto c : text) {
+    if ((c == '"') || (c == '\\')) {
+      os << '\\';
+    }
+    os << c;
+  }
+  os << '"';
+}
+
+void write_json(std::ostream &os, const std::vector<Result> &results) {
+  os << "{\n  \"benchmarks\": [";
+  for (std::size_t i = 0; i < results.size(); i++) {
+    const auto &result = results[i];
+    os << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+    write_json_string(os, result.name);
+    os << ", \"corpus\": ";
+    write_json_string(os, result.corpus);
+    os << ", \"ops\": " << result.ops
+       << ", \"ns_per_op\": " << result.ns_per_op
+       << ", \"mb_per_s\": " << result.mb_per_s
+       << ", \"allocs_per_op\": " << result.allocs_per_op << "}";
+  }
+  os << "\n  ]\n}\n";
+}
+
+[[nodiscard]] std::optional<Options> parse_options(int argc, const char **argv) {
+  Options out;
+  const auto args = std::vector<std::string_view>(argv + 1, argv + argc);
+  for (std::size_t i = 0; i < args.size(); i++) {
+    const auto has_value = (i + 1) < args.size();
+    if ((args[i] == "--resources") && has_value) {
+      out.resources = args[++i];
+    } else if ((args[i] == "--min-time-ms") && has_value) {
+      out.min_time = std::chrono::milliseconds{ngl::util::to_int(args[++i])};
+    } else if ((args[i] == "--filter") && has_value) {
+      out.filter = args[++i];
+    } else if ((args[i] == "--seed") && has_value) {
+      out.seed = std::stoull(std::string{args[++i]});
+    } else if ((args[i] == "--synthetic-bytes") && has_value) {
+      out.synthetic_bytes = std::stoull(std::string{args[++i]});
+    } else {
+      return std::nullopt;
+    }
+  }
+  return out;
+}
+
+} // namespace
+
+auto main(int argc, const char **argv) -> int {
+  const auto options = parse_options(argc, argv);
+  if (!options.has_value()) {
+    std::cerr << "usage: ngl-pokepaste_bench [--resources <dir>] [--min-time-ms <ms>] [--filter <substring>]\n"
+                 "  [--seed <n>] [--synthetic-bytes <n>]\n";
+    return EXIT_FAILURE;
+  }
+
+  Corpus resources;
+  try {
+    resources = load_resources(options->resources);
+  } catch (const std::filesystem::filesystem_error &e) {
+    std::cerr << "ngl-pokepaste_bench: cannot read the resources expected at " << std::filesystem::absolute(options->resources).string() << ": " << e.code().message() << "\n"
+              << "run it from the build's bench directory, or pass --resources <dir>\n";
+    return EXIT_FAILURE;
+  }
+  // Teams of every size, most with every field, and the same mix with CRLF line endings
+  auto generator_options                = ngl::pokepaste::synthetic::Options{};
+  generator_options.seed                = options->seed;
+  generator_options.optional_field_rate = 0.8;
+  const auto generated                  = synthetic("synthetic", generator_options, options->synthetic_bytes);
+  generator_options.crlf_rate           = 1.0;
+  const std::vector<Corpus> corpora{
+    resources,
+    with_crlf(resources),
+    generated,
+    synthetic("synthetic-crlf", generator_options, options->synthetic_bytes),
+    joined(generated),
+  };
+
+  std::vector<Result> results;
+  for (const auto &corpus : corpora) {
+    bench_pastes(corpus, options.value(), results);
+  }
+  bench_lines(resources, options.value(), results);
+  bench_lines(generated, options.value(), results);
+  write_json(std::cout, results);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ngl-pokepaste/synthetic.hpp"
+
+namespace {
+
+struct Arguments {
+  ngl::pokepaste::synthetic::Options options;
+  std::uint64_t bytes = std::uint64_t{1} << 20U;
+  std::optional<std::string> output;
+};
+
+// Accepts a K, M or G suffix, in powers of 1024
+[[nodiscard]] std::uint64_t parse_bytes(std::string_view text) {
+  std::uint64_t scale = 1;
+  if (!text.empty()) {
+    switch (text.back()) {
+    case 'K':
+      scale = std::uint64_t{1} << 10U;
+      break;
+    case 'M':
+      scale = std::uint64_t{1} << 20U;
+      break;
+    case 'G':
+      scale = std::uint64_t{1} << 30U;
+      break;
+    default:
+      break;
+    }
+  }
+  if (scale != 1) {
+    text.remove_suffix(1);
+  }
+  return std::stoull(std::string{text}) * scale;
+}
+
+[[nodiscard]] std::optional<Arguments> parse_arguments(int argc, const char **argv) {
+  Arguments out;
+  auto &options   = out.options;
+  const auto args = std::vector<std::string_view>(argv + 1, argv + argc);
+  for (std::size_t i = 0; i < args.size(); i++) {
+    if ((i + 1) == args.size()) {
+      return std::nullopt;
+    }
+    const auto name  = args[i];
+    const auto value = std::string{args[++i]};
+    if (name == "--seed") {
+      options.seed = std::stoull(value);
+    } else if (name == "--bytes") {
+      out.bytes = parse_bytes(value);
+    } else if (name == "--output") {
+      out.output = value;
+    } else if (name == "--min-pokemon") {
+      options.min_pokemon = std::stoull(value);
+    } else if (name == "--max-pokemon") {
+      options.max_pokemon = std::stoull(value);
+    } else if (name == "--min-moves") {
+      options.min_moves = std::stoull(value);
+    } else if (name == "--max-moves") {
+      options.max_moves = std::stoull(value);
+    } else if (name == "--nickname-rate") {
+      options.nickname_rate = std::stod(value);
+    } else if (name == "--gender-rate") {
+      options.gender_rate = std::stod(value);
+    } else if (name == "--item-rate") {
+      options.item_rate = std::stod(value);
+    } else if (name == "--optional-field-rate") {
+      options.optional_field_rate = std::stod(value);
+    } else if (name == "--crlf-rate") {
+      options.crlf_rate = std::stod(value);
+    } else if (name == "--malformed-rate") {
+      options.malformed_rate = std::stod(value);
+    } else {
+      return std::nullopt;
+    }
+  }
+  if ((options.min_pokemon == 0) || (options.min_pokemon > options.max_pokemon) || (options.min_moves > options.max_moves)) {
+    return std::nullopt;
+  }
+  return out;
+}
+
+} // namespace
+
+// Writes generated pastes separated by empty lines, so the output is itself one large paste. Pastes
+// are produced one at a time, so the output can be far larger than memory
+auto main(int argc, const char **argv) -> int {
+  std::optional<Arguments> arguments;
+  try {
+    arguments = parse_arguments(argc, argv);
+  } catch (const std::exception &) { // NOLINT
+  }
+  if (!arguments.has_value()) {
+    std::cerr << "usage: ngl-pokepaste_generate [--seed <n>] [--bytes <n>[K|M|G]] [--output <file>]\n"
+                 "  [--min-pokemon <n>] [--max-pokemon <n>] [--min-moves <n>] [--max-moves <n>]\n"
+                 "  [--nickname-rate <p>] [--gender-rate <p>] [--item-rate <p>] [--optional-field-rate <p>]\n"
+                 "  [--crlf-rate <p>] [--malformed-rate <p>]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::ofstream file;
+  if (arguments->output.has_value()) {
+    file.open(arguments->output.value(), std::ios::binary);
+    if (!file) {
+      std::cerr << "could not open " << arguments->output.value() << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  auto &out = arguments->output.has_value() ? file : std::cout;
+
+  ngl::pokepaste::synthetic::Generator generator{arguments->options};
+  std::uint64_t written = 0;
+  while (written < arguments->bytes) {
+    const auto paste = generator.paste();
+    if (written > 0) {
+      out << "\n\n";
+      written += 2;
+    }
+    out << paste.text;
+    written += paste.text.size();
+  }
+  out << std::flush;
+  return out ? EXIT_SUCCESS : EXIT_FAILURE;
+}
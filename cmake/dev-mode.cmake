@@ -5,6 +5,11 @@ if(BUILD_TESTING)
   add_subdirectory(test)
 endif()
 
+option(BUILD_BENCHMARKS "Build the ngl-pokepaste_bench benchmark executable" ON)
+if(BUILD_BENCHMARKS)
+  add_subdirectory(bench)
+endif()
+
 option(BUILD_MCSS_DOCS "Build documentation using Doxygen and m.css" OFF)
 if(BUILD_MCSS_DOCS)
   include(cmake/docs.cmake)
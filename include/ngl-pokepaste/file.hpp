@@ -0,0 +1,143 @@
+#ifndef NGL_POKEPASTE_FILE_HPP
+#define NGL_POKEPASTE_FILE_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "ngl-pokepaste/pokepaste.hpp"
+
+#ifndef NGL_POKEPASTE_HAS_MMAP
+#if defined(__unix__) || defined(__APPLE__)
+#define NGL_POKEPASTE_HAS_MMAP 1
+#else
+#define NGL_POKEPASTE_HAS_MMAP 0
+#endif
+#endif
+
+#if NGL_POKEPASTE_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Decoding pastes straight from files, kept apart from pokepaste.hpp so that only code that reads
+// files takes on the filesystem and POSIX headers
+namespace ngl::pokepaste {
+
+namespace detail {
+
+// Read only view of a whole file. Where mmap is available the file is mapped rather than read, so
+// the decoders work directly on the page cache
+class MappedFile {
+public:
+  explicit MappedFile(const std::filesystem::path &path) {
+#if NGL_POKEPASTE_HAS_MMAP
+    const auto fd = ::open(path.c_str(), O_RDONLY); // NOLINT(cppcoreguidelines-pro-type-vararg)
+    if (fd < 0) {
+      throw std::filesystem::filesystem_error{"Could not open paste file", path, std::error_code{errno, std::generic_category()}};
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+      const auto error = errno;
+      ::close(fd);
+      throw std::filesystem::filesystem_error{"Could not stat paste file", path, std::error_code{error, std::generic_category()}};
+    }
+    size_ = static_cast<std::size_t>(info.st_size);
+    // Zero length mappings are invalid; an empty file is just an empty view
+    if (size_ > 0) {
+      data_ = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data_ == MAP_FAILED) { // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+        const auto error = errno;
+        ::close(fd);
+        data_ = nullptr;
+        throw std::filesystem::filesystem_error{"Could not map paste file", path, std::error_code{error, std::generic_category()}};
+      }
+      ::madvise(data_, size_, MADV_SEQUENTIAL);
+    }
+    ::close(fd);
+#else
+    std::ifstream fs{path, std::ios::binary};
+    if (!fs) {
+      throw std::filesystem::filesystem_error{"Could not open paste file", path, std::make_error_code(std::errc::io_error)};
+    }
+    data_.assign(std::istreambuf_iterator<char>{fs}, std::istreambuf_iterator<char>{});
+#endif
+  }
+
+  MappedFile(const MappedFile &)            = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&)                 = delete;
+  MappedFile &operator=(MappedFile &&)      = delete;
+
+  ~MappedFile() {
+#if NGL_POKEPASTE_HAS_MMAP
+    if (data_ != nullptr) {
+      ::munmap(data_, size_);
+    }
+#endif
+  }
+
+  [[nodiscard]] std::string_view view() const noexcept {
+#if NGL_POKEPASTE_HAS_MMAP
+    return {static_cast<const char *>(data_), size_};
+#else
+    return data_;
+#endif
+  }
+
+private:
+#if NGL_POKEPASTE_HAS_MMAP
+  void *data_       = nullptr;
+  std::size_t size_ = 0;
+#else
+  std::string data_;
+#endif
+};
+
+} // namespace detail
+
+[[nodiscard]] inline PokePaste decode_pokepaste_file(const std::filesystem::path &path) {
+  const detail::MappedFile file{path};
+  return decode_pokepaste(file.view());
+}
+
+struct PokePasteFile {
+  std::filesystem::path path;
+  PokePaste paste;
+};
+
+// Decodes every file under directory with the given extension (or every file if it is empty),
+// ordered by path
+[[nodiscard]] inline std::vector<PokePasteFile> decode_pokepaste_directory(
+  const std::filesystem::path &directory, std::string_view extension = ".paste"
+) {
+  std::vector<std::filesystem::path> paths;
+  for (const auto &entry : std::filesystem::recursive_directory_iterator{directory}) {
+    if (entry.is_regular_file() && (extension.empty() || (entry.path().extension() == extension))) {
+      paths.push_back(entry.path());
+    }
+  }
+  std::ranges::sort(paths);
+
+  std::vector<PokePasteFile> out;
+  out.reserve(paths.size());
+  for (auto &path : paths) {
+    auto paste = decode_pokepaste_file(path);
+    out.push_back(PokePasteFile{std::move(path), std::move(paste)});
+  }
+  return out;
+}
+
+} // namespace ngl::pokepaste
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef NGL_POKEPASTE_PARALLEL_HPP
+#define NGL_POKEPASTE_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ngl-pokepaste/pokepaste.hpp"
+
+// Decoding batches of pastes across threads. Kept apart from pokepaste.hpp, so only code that
+// includes this needs to link a thread library, eg. Threads::Threads from CMake's FindThreads
+namespace ngl::pokepaste {
+
+struct DecodeResult {
+  PokePaste paste;
+  // Whatever decode_pokepaste threw for this input, or null on success
+  std::exception_ptr error;
+
+  [[nodiscard]] bool ok() const noexcept {
+    return error == nullptr;
+  }
+};
+
+namespace detail {
+
+// Work owned by one decode_many worker. Its owner claims indices from the front, and once a
+// worker's own range runs dry it claims from the others', so a few slow pastes can't leave
+// the remaining threads idle. Kept on separate cache lines so claims don't contend
+struct alignas(64) WorkRange {
+  std::atomic<std::size_t> next = 0;
+  std::size_t end               = 0;
+};
+
+} // namespace detail
+
+// Decodes independent pastes across thread_count threads (hardware concurrency if 0), including the
+// calling thread. Results are in input order; a paste that fails to decode doesn't affect the others.
+// The threads are started for each call, which is cheap next to decoding a batch worth splitting,
+// so pass 1 to decode small batches on the calling thread alone
+[[nodiscard]] inline std::vector<DecodeResult> decode_many(
+  std::span<const std::string_view> pastes, std::size_t thread_count = 0
+) {
+  std::vector<DecodeResult> out(pastes.size());
+  if (thread_count == 0) {
+    thread_count = std::max(std::size_t{1}, static_cast<std::size_t>(std::thread::hardware_concurrency()));
+  }
+  thread_count = std::max(std::size_t{1}, std::min(thread_count, pastes.size()));
+
+  std::vector<detail::WorkRange> ranges(thread_count);
+  for (std::size_t i = 0; i < thread_count; i++) {
+    ranges[i].next = (pastes.size() * i) / thread_count;
+    ranges[i].end  = (pastes.size() * (i + 1)) / thread_count;
+  }
+
+  const auto work = [&](std::size_t worker) {
+    for (std::size_t offset = 0; offset < thread_count; offset++) {
+      auto &range = ranges[(worker + offset) % thread_count];
+      for (auto index = range.next.fetch_add(1, std::memory_order_relaxed); index < range.end; index = range.next.fetch_add(1, std::memory_order_relaxed)) {
+        try {
+          auto result = try_decode_pokepaste(pastes[index]);
+          if (result.ok()) {
+            out[index].paste = std::move(result.value);
+          } else {
+            out[index].error = detail::make_decode_exception(result.error->code);
+          }
+        } catch (...) {
+          out[index].error = std::current_exception();
+        }
+      }
+    }
+  };
+
+  {
+    // jthreads join as they are destroyed, so if starting one throws, the ones already running finish
+    // the work before the exception leaves
+    std::vector<std::jthread> threads;
+    threads.reserve(thread_count - 1);
+    for (std::size_t worker = 1; worker < thread_count; worker++) {
+      threads.emplace_back(work, worker);
+    }
+    work(0);
+  }
+  return out;
+}
+
+} // namespace ngl::pokepaste
+
+#endif
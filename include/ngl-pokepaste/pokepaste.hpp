@@ -2,25 +2,61 @@
 #define NGL_POKEPASTE_POKEPASTE_HPP
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <cassert>
 #include <cctype>
+#include <charconv>
+#include <chrono>
 #include <compare>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
 #include <format>
+#include <functional>
+#include <initializer_list>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <span>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <tuple>
 #include <unordered_map>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
+// Collects DecodeCounters from the decoders. Off by default, in which case every hook compiles away
+#ifndef NGL_POKEPASTE_INSTRUMENT
+#define NGL_POKEPASTE_INSTRUMENT 0
+#endif
+
+#ifndef NGL_POKEPASTE_HAS_X86_SIMD
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define NGL_POKEPASTE_HAS_X86_SIMD 1
+#else
+#define NGL_POKEPASTE_HAS_X86_SIMD 0
+#endif
+#endif
+
+#if NGL_POKEPASTE_HAS_X86_SIMD
+#include <immintrin.h>
+#endif
+
 namespace ngl {
 namespace util {
 
 template <typename T>
-[[nodiscard]] auto to_underlying(T value) {
+[[nodiscard]] constexpr auto to_underlying(T value) {
   static_assert(std::is_enum_v<T>);
   return static_cast<std::underlying_type_t<T>>(value);
 }
@@ -75,14 +111,72 @@ template <typename T>
   return str.substr(begin, end - begin + 1);
 }
 
-[[nodiscard]] inline bool starts_with(const std::string &str, const std::string &prefix) {
+// Non-owning counterpart of trim; the result refers into str
+[[nodiscard]] constexpr std::string_view trim_view(std::string_view str) noexcept {
+  const auto begin = str.find_first_not_of(" \t\r\n");
+
+  if (begin == std::string_view::npos) {
+    return {};
+  }
+
+  const auto end = str.find_last_not_of(" \t\r\n");
+  return str.substr(begin, end - begin + 1);
+}
+
+[[nodiscard]] constexpr bool starts_with(std::string_view str, std::string_view prefix) noexcept {
   return (str.size() >= prefix.size()) && (std::equal(prefix.begin(), prefix.end(), str.begin()));
 }
 
-[[nodiscard]] inline bool ends_with(const std::string &str, const std::string &suffix) {
+[[nodiscard]] constexpr bool ends_with(std::string_view str, std::string_view suffix) noexcept {
   return (str.size() >= suffix.size()) && (std::equal(suffix.rbegin(), suffix.rend(), str.rbegin()));
 }
 
+// Position of the final delimiter found when scanning str left to right the way split does, so
+// str.substr(0, pos) is what joining every part of split(str, delimiter) but the last would give
+[[nodiscard]] constexpr std::size_t find_last_split(std::string_view str, std::string_view delimiter) noexcept {
+  auto last = std::string_view::npos;
+  for (auto pos = str.find(delimiter); pos != std::string_view::npos; pos = str.find(delimiter, pos + delimiter.size())) {
+    last = pos;
+  }
+  return last;
+}
+
+[[nodiscard]] inline bool iequals(std::string_view lhs, std::string_view rhs) noexcept {
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](char l, char r) {
+    return std::tolower(static_cast<unsigned char>(l)) == std::tolower(static_cast<unsigned char>(r));
+  });
+}
+
+// Parses the leading integer in str with the same rules as std::stoi, reporting failure like
+// std::from_chars. out is only written on success
+[[nodiscard]] inline std::errc try_to_int(std::string_view str, int &out) noexcept {
+  const auto *first = str.data();
+  const auto *last  = str.data() + str.size();
+  while ((first != last) && std::isspace(static_cast<unsigned char>(*first))) {
+    first++;
+  }
+  if ((first != last) && (*first == '+')) {
+    first++;
+    if ((first != last) && (*first == '-')) {
+      return std::errc::invalid_argument;
+    }
+  }
+  return std::from_chars(first, last, out).ec;
+}
+
+// Parses the leading integer in str with the same rules and exceptions as std::stoi
+[[nodiscard]] inline int to_int(std::string_view str) {
+  int value       = 0;
+  const auto code = try_to_int(str, value);
+  if (code == std::errc::invalid_argument) {
+    throw std::invalid_argument{"Integer value is malformed"};
+  }
+  if (code == std::errc::result_out_of_range) {
+    throw std::out_of_range{"Integer value is out of range"};
+  }
+  return value;
+}
+
 [[nodiscard]] inline bool contains(const std::string &str, const std::string &find) {
   return split(str, find).size() > 1;
 }
@@ -103,6 +197,278 @@ template <typename T>
   return out;
 }
 
+// Vector that keeps up to N elements inline and only allocates once it grows past them, at which
+// point every element moves to the heap. Elements are always contiguous
+template <typename T, std::size_t N>
+class SmallVector {
+public:
+  using value_type     = T;
+  using size_type      = std::size_t;
+  using iterator       = T *;
+  using const_iterator = const T *;
+
+  SmallVector() = default;
+
+  // Copies only the elements in [0, size()), not the ones clear() kept for reuse
+  SmallVector(const SmallVector &other) {
+    assign(other.begin(), other.end());
+  }
+
+  SmallVector &operator=(const SmallVector &other) {
+    if (this != &other) {
+      assign(other.begin(), other.end());
+    }
+    return *this;
+  }
+
+  // The moved-from vector is left empty
+  SmallVector(SmallVector &&other) noexcept
+      : inline_{std::move(other.inline_)}, size_{std::exchange(other.size_, 0)}, spilled_{std::exchange(other.spilled_, false)}, heap_{std::move(other.heap_)} {
+    other.heap_.clear();
+  }
+
+  SmallVector &operator=(SmallVector &&other) noexcept {
+    inline_  = std::move(other.inline_);
+    size_    = std::exchange(other.size_, 0);
+    spilled_ = std::exchange(other.spilled_, false);
+    heap_    = std::move(other.heap_);
+    other.heap_.clear();
+    return *this;
+  }
+
+  ~SmallVector() = default;
+
+  SmallVector(std::initializer_list<T> values) {
+    assign(values.begin(), values.end());
+  }
+
+  // Lets code written against std::vector keep assigning one, and keep taking copies as one
+  SmallVector(const std::vector<T> &values) { // NOLINT(google-explicit-constructor)
+    assign(values.begin(), values.end());
+  }
+
+  operator std::vector<T>() const { // NOLINT(google-explicit-constructor)
+    return std::vector<T>(begin(), end());
+  }
+
+  template <typename It>
+  void assign(It first, It last) {
+    clear();
+    if constexpr (std::forward_iterator<It>) {
+      reserve(static_cast<std::size_t>(std::distance(first, last)));
+    }
+    for (; first != last; first++) {
+      emplace_back(*first);
+    }
+  }
+
+  // Only allocates when more than N elements are requested
+  void reserve(std::size_t capacity) {
+    if (capacity > N) {
+      heap_.reserve(capacity);
+    }
+  }
+
+  template <typename... Args>
+  T &emplace_back(Args &&...args) {
+    if (has_inline_room()) {
+      inline_[size_] = T(std::forward<Args>(args)...);
+      return inline_[size_++];
+    }
+    if (inlined()) {
+      return spill_back(T(std::forward<Args>(args)...));
+    }
+    if (size_ < heap_.size()) {
+      heap_[size_] = T(std::forward<Args>(args)...);
+      return heap_[size_++];
+    }
+    auto &out = heap_.emplace_back(std::forward<Args>(args)...);
+    size_++;
+    return out;
+  }
+
+  // Assigning into a slot left by clear() lets it keep its storage
+  template <typename Arg>
+    requires std::is_assignable_v<T &, Arg &&>
+  T &emplace_back(Arg &&arg) {
+    if (has_inline_room()) {
+      inline_[size_] = std::forward<Arg>(arg);
+      return inline_[size_++];
+    }
+    if (inlined()) {
+      return spill_back(std::forward<Arg>(arg));
+    }
+    if (size_ < heap_.size()) {
+      heap_[size_] = std::forward<Arg>(arg);
+      return heap_[size_++];
+    }
+    auto &out = heap_.emplace_back(std::forward<Arg>(arg));
+    size_++;
+    return out;
+  }
+
+  void push_back(const T &value) {
+    emplace_back(value);
+  }
+
+  void push_back(T &&value) {
+    emplace_back(std::move(value));
+  }
+
+  // Like clear(), these only shrink size(), so the elements past it keep their storage for reuse
+  void pop_back() noexcept {
+    size_--;
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    const auto index = static_cast<std::size_t>(first - begin());
+    const auto count = static_cast<std::size_t>(last - first);
+    std::move(begin() + index + count, end(), begin() + index);
+    size_ -= count;
+    return begin() + index;
+  }
+
+  iterator erase(const_iterator position) {
+    return erase(position, position + 1);
+  }
+
+  iterator insert(const_iterator position, T value) {
+    const auto index = static_cast<std::size_t>(position - begin());
+    emplace_back(std::move(value));
+    std::rotate(begin() + index, end() - 1, end());
+    return begin() + index;
+  }
+
+  void resize(std::size_t count, const T &value = T{}) {
+    if (count <= size_) {
+      size_ = count;
+      return;
+    }
+    // value may be one of the elements, which growing can move or reallocate
+    const T fill = value;
+    reserve(count);
+    while (size_ < count) {
+      emplace_back(fill);
+    }
+  }
+
+  // Returns to the inline elements, but keeps the heap ones alive for a later spill to swap into, so
+  // neither the heap storage nor that of the elements themselves is freed
+  void clear() noexcept {
+    size_    = 0;
+    spilled_ = false;
+  }
+
+  [[nodiscard]] bool inlined() const noexcept {
+    return !spilled_;
+  }
+  [[nodiscard]] std::size_t size() const noexcept {
+    return size_;
+  }
+  [[nodiscard]] bool empty() const noexcept {
+    return size() == 0;
+  }
+  // Storage kept from an earlier spill counts even while the elements are inline
+  [[nodiscard]] std::size_t capacity() const noexcept {
+    return inlined() ? std::max(N, heap_.capacity()) : heap_.capacity();
+  }
+  [[nodiscard]] T *data() noexcept {
+    return inlined() ? inline_.data() : heap_.data();
+  }
+  [[nodiscard]] const T *data() const noexcept {
+    return inlined() ? inline_.data() : heap_.data();
+  }
+  [[nodiscard]] iterator begin() noexcept {
+    return data();
+  }
+  [[nodiscard]] iterator end() noexcept {
+    return data() + size();
+  }
+  [[nodiscard]] const_iterator begin() const noexcept {
+    return data();
+  }
+  [[nodiscard]] const_iterator end() const noexcept {
+    return data() + size();
+  }
+  [[nodiscard]] T &operator[](std::size_t index) noexcept {
+    return data()[index];
+  }
+  [[nodiscard]] const T &operator[](std::size_t index) const noexcept {
+    return data()[index];
+  }
+  [[nodiscard]] T &at(std::size_t index) {
+    if (index >= size()) {
+      throw std::out_of_range{"SmallVector index out of range"};
+    }
+    return data()[index];
+  }
+  [[nodiscard]] const T &at(std::size_t index) const {
+    if (index >= size()) {
+      throw std::out_of_range{"SmallVector index out of range"};
+    }
+    return data()[index];
+  }
+  [[nodiscard]] T &front() noexcept {
+    return data()[0];
+  }
+  [[nodiscard]] const T &front() const noexcept {
+    return data()[0];
+  }
+  [[nodiscard]] T &back() noexcept {
+    return data()[size() - 1];
+  }
+  [[nodiscard]] const T &back() const noexcept {
+    return data()[size() - 1];
+  }
+
+  [[nodiscard]] friend bool operator==(const SmallVector &lhs, const SmallVector &rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+  }
+  [[nodiscard]] friend auto operator<=>(const SmallVector &lhs, const SmallVector &rhs) {
+    return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+  }
+
+private:
+  [[nodiscard]] bool has_inline_room() const noexcept {
+    return inlined() && (size_ < N);
+  }
+
+  // Moves the inline elements to the heap once they no longer fit, then appends value. value may be
+  // one of those elements, so like std::vector it is stored before they move. heap_ may hold more
+  // elements than size_, left by clear(), which are swapped with the inline ones so both keep their
+  // storage
+  template <typename Arg>
+  T &spill_back(Arg &&value) {
+    // Room reserve() already made for more than N is kept as it is
+    if (heap_.capacity() <= N) {
+      heap_.reserve(2 * N);
+    }
+    if (size_ < heap_.size()) {
+      heap_[size_] = std::forward<Arg>(value);
+      for (std::size_t i = 0; i < size_; i++) {
+        std::swap(inline_[i], heap_[i]);
+      }
+    } else {
+      T element(std::forward<Arg>(value));
+      for (std::size_t i = 0; i < size_; i++) {
+        if (i < heap_.size()) {
+          std::swap(inline_[i], heap_[i]);
+        } else {
+          heap_.push_back(std::move(inline_[i]));
+        }
+      }
+      heap_.push_back(std::move(element));
+    }
+    spilled_ = true;
+    return heap_[size_++];
+  }
+
+  std::array<T, N> inline_{};
+  std::size_t size_ = 0;
+  bool spilled_     = false;
+  std::vector<T> heap_;
+};
+
 } // namespace util
 
 namespace pokepaste {
@@ -149,6 +515,8 @@ struct Pokemon {
   constexpr static std::size_t DEFAULT_HAPPINESS     = 255;
   constexpr static std::size_t DEFAULT_DYNAMAX_LEVEL = 10;
   constexpr static Stats DEFAULT_IVS                 = {31, 31, 31, 31, 31, 31};
+  // Real sets have at most 4 moves, which are stored without allocating
+  constexpr static std::size_t INLINE_MOVES = 4;
 
   std::optional<std::string> nickname = std::nullopt;
   std::string species;
@@ -166,7 +534,9 @@ struct Pokemon {
   Stats evs;
   std::optional<std::string> nature;
   Stats ivs = DEFAULT_IVS;
-  std::vector<std::string> moves;
+  // Decoding into a reused Pokemon keeps the capacity and the old move strings past size(), so their
+  // storage can be reused. Copies only take the current moves
+  util::SmallVector<std::string, INLINE_MOVES> moves;
 
   [[nodiscard]] bool operator==(const Pokemon &) const                  = default;
   [[nodiscard]] std::strong_ordering operator<=>(const Pokemon &) const = default;
@@ -174,539 +544,3898 @@ struct Pokemon {
 
 using PokePaste = std::vector<Pokemon>;
 
+// Pokemon whose strings refer into the paste it was decoded from, so it must not outlive that buffer
+struct PokemonView {
+  constexpr static std::size_t MAX_MOVES = 4;
+
+  std::optional<std::string_view> nickname = std::nullopt;
+  std::string_view species;
+  std::optional<Gender> gender         = std::nullopt;
+  std::optional<std::string_view> item = std::nullopt;
+
+  // showdown import/export order
+  std::string_view ability;
+  std::optional<std::size_t> level;
+  bool shiny                = false;
+  std::size_t happiness     = Pokemon::DEFAULT_HAPPINESS;
+  std::size_t dynamax_level = Pokemon::DEFAULT_DYNAMAX_LEVEL;
+  bool gigantamax           = false;
+  std::optional<std::string_view> tera_type;
+  Pokemon::Stats evs;
+  std::optional<std::string_view> nature;
+  Pokemon::Stats ivs = Pokemon::DEFAULT_IVS;
+  std::array<std::string_view, MAX_MOVES> moves;
+  std::size_t move_count = 0;
+
+  [[nodiscard]] std::span<const std::string_view> move_list() const noexcept {
+    return std::span{moves}.first(move_count);
+  }
+
+  [[nodiscard]] Pokemon to_owned() const {
+    Pokemon out;
+    out.nickname      = nickname;
+    out.species       = species;
+    out.gender        = gender;
+    out.item          = item;
+    out.ability       = ability;
+    out.level         = level;
+    out.shiny         = shiny;
+    out.happiness     = happiness;
+    out.dynamax_level = dynamax_level;
+    out.gigantamax    = gigantamax;
+    out.tera_type     = tera_type;
+    out.evs           = evs;
+    out.nature        = nature;
+    out.ivs           = ivs;
+    out.moves.reserve(move_count);
+    for (const auto move : move_list()) {
+      out.moves.emplace_back(move);
+    }
+    return out;
+  }
+
+private:
+  [[nodiscard]] auto fields() const noexcept {
+    return std::tie(nickname, species, gender, item, ability, level, shiny, happiness, dynamax_level, gigantamax, tera_type, evs, nature, ivs);
+  }
+
+  // Only the first move_count moves take part, the rest may be left over from an earlier decode
+  [[nodiscard]] friend bool operator==(const PokemonView &lhs, const PokemonView &rhs) noexcept {
+    const auto lhs_moves = lhs.move_list();
+    const auto rhs_moves = rhs.move_list();
+    return (lhs.fields() == rhs.fields()) &&
+           std::equal(lhs_moves.begin(), lhs_moves.end(), rhs_moves.begin(), rhs_moves.end());
+  }
+  [[nodiscard]] friend std::strong_ordering operator<=>(const PokemonView &lhs, const PokemonView &rhs) noexcept {
+    if (const auto order = lhs.fields() <=> rhs.fields(); order != 0) {
+      return order;
+    }
+    const auto lhs_moves = lhs.move_list();
+    const auto rhs_moves = rhs.move_list();
+    return std::lexicographical_compare_three_way(lhs_moves.begin(), lhs_moves.end(), rhs_moves.begin(), rhs_moves.end());
+  }
+};
+
+using PokePasteView = std::vector<PokemonView>;
+
+[[nodiscard]] inline PokePaste to_owned(const PokePasteView &paste) {
+  PokePaste out;
+  out.reserve(paste.size());
+  for (const auto &pokemon : paste) {
+    out.push_back(pokemon.to_owned());
+  }
+  return out;
+}
+
 class domain_bound_error : public std::runtime_error {
   using std::runtime_error::runtime_error;
 };
 
-namespace detail {
+// The kinds of line a Pokemon is made up of
+enum class FieldKind : uint8_t {
+  Name,
+  Ability,
+  Level,
+  Shiny,
+  Happiness,
+  DynamaxLevel,
+  Gigantamax,
+  TeraType,
+  EVs,
+  Nature,
+  IVs,
+  Move
+};
 
-struct SpeciesLineInfo {
-  std::optional<std::string> nickname;
-  std::string species;
-  std::optional<Gender> gender;
-  std::optional<std::string> item;
-  [[nodiscard]] bool operator==(
-    const SpeciesLineInfo &
-  ) const noexcept = default;
-  [[nodiscard]] std::strong_ordering operator<=>(
-    const SpeciesLineInfo &
-  ) const noexcept = default;
+// Why a paste failed to decode
+enum class DecodeErrc : uint8_t {
+  UnknownLine,
+  DuplicateLine,
+  NotEnoughLines,
+  MissingAbility,
+  MalformedName,
+  EmptyAbility,
+  EmptyTeraType,
+  EmptyNature,
+  EmptyMove,
+  MalformedInteger,
+  IntegerOutOfRange,
+  LevelTooLow,
+  HappinessTooLow,
+  DynamaxLevelTooLow,
+  InvalidBool,
+  InvalidShiny,
+  InvalidGigantamax,
+  EmptyStats,
+  TooManyStats,
+  MalformedStatEntry,
+  NegativeStat,
+  UnknownStat,
+  DuplicateStat,
+  TooManyMoves,
+  MalformedPacked,
+  MalformedPackedStats,
+  InvalidPackedGender,
+  InvalidPackedShiny,
+  InvalidPackedGigantamax
 };
 
-[[nodiscard]] inline std::string encode_string_line(const std::string &line, const std::string &prefix) {
-  return std::format("{} {}", util::trim(prefix), util::trim(line));
+// The what() of the exception the throwing API reports code with
+[[nodiscard]] constexpr std::string_view decode_error_message(DecodeErrc code) noexcept {
+  switch (code) {
+  case DecodeErrc::UnknownLine:
+    return "Unknown line in Pokemon data";
+  case DecodeErrc::DuplicateLine:
+    return "Duplicate line detected";
+  case DecodeErrc::NotEnoughLines:
+    return "Not enough lines in Pokemon data";
+  case DecodeErrc::MissingAbility:
+    return "Pokemon requires Ability data";
+  case DecodeErrc::MalformedName:
+    return "Malformed nickname and species data";
+  case DecodeErrc::EmptyAbility:
+    return "Pokemon Ability line must contain a value";
+  case DecodeErrc::EmptyTeraType:
+    return "Pokemon's Tera Type line must contain a value";
+  case DecodeErrc::EmptyNature:
+    return "Pokemon Nature line must contain a value";
+  case DecodeErrc::EmptyMove:
+    return "Pokemon Move line must contain a value";
+  case DecodeErrc::MalformedInteger:
+    return "Integer value is malformed";
+  case DecodeErrc::IntegerOutOfRange:
+    return "Integer value is out of range";
+  case DecodeErrc::LevelTooLow:
+    return "Pokemon Level cannot be less than 0";
+  case DecodeErrc::HappinessTooLow:
+    return "Pokemon Happiness cannot be less than 0";
+  case DecodeErrc::DynamaxLevelTooLow:
+    return "Pokemon Dynamax Level cannot be less than 0";
+  case DecodeErrc::InvalidBool:
+    return R"(Boolean data payload must be "Yes" or "No")";
+  case DecodeErrc::InvalidShiny:
+    return R"(Pokemon Shiny line data must be "Yes" or "No")";
+  case DecodeErrc::InvalidGigantamax:
+    return R"(Pokemon Gigantamax line data must be "Yes" or "No")";
+  case DecodeErrc::EmptyStats:
+    return "Pokemon stat line must contain at least one value";
+  case DecodeErrc::TooManyStats:
+    return "Pokemon may not specify more than 6 stat values";
+  case DecodeErrc::MalformedStatEntry:
+    return "Stat entry data is malformed";
+  case DecodeErrc::NegativeStat:
+    return "Stat value cannot be less than 0";
+  case DecodeErrc::UnknownStat:
+    return "Invalid stat name";
+  case DecodeErrc::DuplicateStat:
+    return "Pokemon may not specify multiple values for a single stat";
+  case DecodeErrc::TooManyMoves:
+    return "PokemonView cannot hold more than 4 moves";
+  case DecodeErrc::MalformedPacked:
+    return "Packed Pokemon must have 12 fields separated by '|', the last holding at most 6 separated by ','";
+  case DecodeErrc::MalformedPackedStats:
+    return "Packed stats must be empty or 6 values separated by ','";
+  case DecodeErrc::InvalidPackedGender:
+    return R"(Packed Pokemon gender must be "M", "F", "N" or empty)";
+  case DecodeErrc::InvalidPackedShiny:
+    return R"(Packed Pokemon shininess must be "S" or empty)";
+  case DecodeErrc::InvalidPackedGigantamax:
+    return R"(Packed Pokemon Gigantamax must be "G" or empty)";
+  default:
+    return "Unknown decode error";
+  }
 }
 
-[[nodiscard]] inline std::string decode_string_line(const std::string &line, const std::string &prefix) {
-  assert(util::starts_with(line, prefix));
-  return util::trim(line.substr(prefix.size()));
-}
+// Where and why decoding stopped. line and column are 1-based and point at the offending text; field
+// is the kind of line it was on, if that line was recognised
+struct DecodeError {
+  DecodeErrc code    = DecodeErrc::UnknownLine;
+  std::size_t line   = 0;
+  std::size_t column = 0;
+  std::optional<FieldKind> field;
 
-[[nodiscard]] inline std::string encode_number_line(int number, const std::string &prefix) {
-  return encode_string_line(std::to_string(number), prefix);
-}
+  [[nodiscard]] std::string_view message() const noexcept {
+    return decode_error_message(code);
+  }
 
-[[nodiscard]] inline int decode_number_line(const std::string &line, const std::string &prefix) {
-  assert(util::starts_with(line, prefix));
-  const auto str = decode_string_line(line, prefix);
-  return std::stoi(str);
-}
+  [[nodiscard]] bool operator==(const DecodeError &) const noexcept = default;
+};
 
-[[nodiscard]] inline std::string encode_bool_line(bool value, const std::string &prefix) {
-  return encode_string_line(value ? "Yes" : "No", prefix);
-}
+// A malformed Pokemon skipped by decode_pokepaste_recovering. block is its 0-based position among all
+// the blocks of the paste, counting the ones that decoded
+struct BlockDecodeError {
+  std::size_t block = 0;
+  DecodeError error;
 
-[[nodiscard]] inline bool decode_bool_line(const std::string &line, const std::string &prefix) {
-  assert(util::starts_with(line, prefix));
-  const auto str = util::to_lower(decode_string_line(line, prefix));
-  if (str == "yes") {
-    return true;
-  }
+  [[nodiscard]] bool operator==(const BlockDecodeError &) const noexcept = default;
+};
 
-  if (str == "no") {
-    return false;
+// Outcome of the try_decode_* functions, which report malformed input here instead of throwing.
+// value is left default constructed if decoding failed
+template <typename T>
+struct TryDecodeResult {
+  T value;
+  std::optional<DecodeError> error;
+
+  [[nodiscard]] bool ok() const noexcept {
+    return !error.has_value();
   }
+};
 
-  throw std::runtime_error{R"(Boolean data payload must be "Yes" or "No")"};
-}
+constexpr bool DECODE_INSTRUMENTED = NGL_POKEPASTE_INSTRUMENT != 0;
 
-[[nodiscard]] inline std::string encode_stat_line(
-  const Pokemon::Stats &stats,
-  const std::string &prefix,
-  const Pokemon::Stats &baseline = {}
-) {
-  std::vector<std::string> parts;
-  if (stats.hp != baseline.hp) {
-    parts.push_back(std::format("{} HP", std::to_string(stats.hp)));
-  }
-  if (stats.atk != baseline.atk) {
-    parts.push_back(std::format("{} Atk", std::to_string(stats.atk)));
-  }
-  if (stats.def != baseline.def) {
-    parts.push_back(std::format("{} Def", std::to_string(stats.def)));
+// Where decoding spends its time. Dispatch covers handling every line after the name line, including
+// the time counted under Stats
+enum class DecodePhase : uint8_t {
+  Split,
+  NameLine,
+  Stats,
+  Dispatch
+};
+
+// What the decoders have done on one or more threads. Only collected when NGL_POKEPASTE_INSTRUMENT is
+// nonzero, otherwise every counter stays 0. Snapshots are plain values: add them to aggregate threads,
+// subtract them to measure an interval
+struct DecodeCounters {
+  constexpr static std::size_t FIELD_KINDS = util::to_underlying(FieldKind::Move) + 1;
+  constexpr static std::size_t PHASES      = util::to_underlying(DecodePhase::Dispatch) + 1;
+
+  // Lines decoded, indexed by FieldKind
+  std::array<std::uint64_t, FIELD_KINDS> lines{};
+  std::uint64_t unknown_lines = 0;
+  // Input bytes searched for line breaks
+  std::uint64_t bytes_scanned = 0;
+  // Not counted from the allocator: a decoder adds one whenever a string or container it writes to has
+  // to grow past its capacity, or a new string is longer than the small string buffer. Allocators that
+  // round up, reuse memory or allocate on their own make the real count differ
+  std::uint64_t estimated_allocations = 0;
+  std::uint64_t exceptions            = 0;
+  // Nanoseconds, indexed by DecodePhase
+  std::array<std::uint64_t, PHASES> phase_ns{};
+
+  [[nodiscard]] std::uint64_t lines_of(FieldKind kind) const noexcept {
+    return lines[util::to_underlying(kind)];
   }
-  if (stats.spatk != baseline.spatk) {
-    parts.push_back(std::format("{} SpA", std::to_string(stats.spatk)));
+
+  [[nodiscard]] std::chrono::nanoseconds time_in(DecodePhase phase) const noexcept {
+    return std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(phase_ns[util::to_underlying(phase)])};
   }
-  if (stats.spdef != baseline.spdef) {
-    parts.push_back(std::format("{} SpD", std::to_string(stats.spdef)));
+
+  DecodeCounters &operator+=(const DecodeCounters &other) noexcept {
+    combine(other, [](std::uint64_t &lhs, std::uint64_t rhs) { lhs += rhs; });
+    return *this;
   }
-  if (stats.spd != baseline.spd) {
-    parts.push_back(std::format("{} Spe", std::to_string(stats.spd)));
+
+  DecodeCounters &operator-=(const DecodeCounters &other) noexcept {
+    combine(other, [](std::uint64_t &lhs, std::uint64_t rhs) { lhs -= rhs; });
+    return *this;
   }
-  return encode_string_line(util::join(parts, " / "), prefix);
-}
 
-[[nodiscard]] inline Pokemon::Stats decode_stat_line(
-  const std::string &line, const std::string &prefix, const Pokemon::Stats &default_stats = {}
-) {
-  const auto body    = decode_string_line(line, prefix);
-  const auto entries = util::split(body, "/");
-  if (entries.empty()) {
-    throw std::runtime_error{
-      "Pokemon stat line must contain at least one value"
-    };
+  [[nodiscard]] friend DecodeCounters operator+(DecodeCounters lhs, const DecodeCounters &rhs) noexcept {
+    return lhs += rhs;
   }
-  if (entries.size() > Pokemon::Stats::NUM_STATS) {
-    throw std::runtime_error{"Pokemon may not specify more than 6 stat values"};
+
+  [[nodiscard]] friend DecodeCounters operator-(DecodeCounters lhs, const DecodeCounters &rhs) noexcept {
+    return lhs -= rhs;
   }
 
-  auto stats                                        = default_stats;
-  const std::unordered_set<std::string> valid_stats = {"hp", "atk", "def", "spa", "spd", "spe"};
-  std::unordered_map<std::string, std::size_t> stat_history;
-  for (const auto &raw_entry : entries) {
-    const auto parts = util::split(util::trim(raw_entry), " ");
-    if (parts.size() != 2) {
-      throw std::runtime_error{"Stat entry data is malformed"};
+  [[nodiscard]] bool operator==(const DecodeCounters &) const noexcept = default;
+
+private:
+  template <typename Fn>
+  void combine(const DecodeCounters &other, Fn &&fn) noexcept {
+    for (std::size_t i = 0; i < FIELD_KINDS; i++) {
+      fn(lines[i], other.lines[i]);
     }
-    const auto value = std::stoi(parts.front());
-    if (value < 0) {
-      throw std::runtime_error{"Stat value cannot be less than 0"};
-    }
-    const auto stat = util::to_lower(util::trim(parts.back()));
-    if (!valid_stats.contains(stat)) {
-      throw std::runtime_error{"Invalid stat name"};
-    }
-    if (stat_history.contains(stat)) {
-      throw std::runtime_error{
-        "Pokemon may not specify multiple values for a single stat"
-      };
-    }
-    stat_history[stat] = static_cast<std::size_t>(value);
-  }
-
-  for (const auto &[key, value] : stat_history) {
-    if (key == "hp") {
-      stats.hp = value;
-    } else if (key == "atk") {
-      stats.atk = value;
-    } else if (key == "def") {
-      stats.def = value;
-    } else if (key == "spa") {
-      stats.spatk = value;
-    } else if (key == "spd") {
-      stats.spdef = value;
-    } else if (key == "spe") {
-      stats.spd = value;
-    } else {
-      throw std::runtime_error{"Unreachable"};
+    fn(unknown_lines, other.unknown_lines);
+    fn(bytes_scanned, other.bytes_scanned);
+    fn(estimated_allocations, other.estimated_allocations);
+    fn(exceptions, other.exceptions);
+    for (std::size_t i = 0; i < PHASES; i++) {
+      fn(phase_ns[i], other.phase_ns[i]);
     }
   }
+};
 
-  return stats;
-}
+namespace detail {
 
-[[nodiscard]] inline std::string encode_name_line(const SpeciesLineInfo &info) {
-  std::string out;
-  if (info.nickname.has_value()) {
-    out.append(info.nickname.value());
-    out.append(" (");
-    out.append(info.species);
-    out.append(")");
-  } else {
-    out.append(info.species);
+// Counters without their own slot follow the per-line ones
+enum class Counter : std::uint8_t {
+  UnknownLines = DecodeCounters::FIELD_KINDS,
+  BytesScanned,
+  EstimatedAllocations,
+  Exceptions,
+  FirstPhase
+};
+
+#if NGL_POKEPASTE_INSTRUMENT
+
+// One thread's counters. Only the owning thread writes them, so a relaxed load and store is enough to
+// add to one, and any thread may read them for a snapshot
+class ThreadCounters {
+public:
+  constexpr static std::size_t SLOTS = util::to_underlying(Counter::FirstPhase) + DecodeCounters::PHASES;
+
+  void add(std::size_t slot, std::uint64_t amount) noexcept {
+    auto &cell = cells_[slot];
+    cell.store(cell.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
   }
 
-  if (info.gender.has_value()) {
-    switch (info.gender.value()) {
-    case Gender::M:
-      out.append(" (M)");
-      break;
-    case Gender::F:
-      out.append(" (F)");
-      break;
-    default:
-      throw std::runtime_error{"Unreachable"};
+  [[nodiscard]] DecodeCounters snapshot() const noexcept {
+    const auto load = [&](std::size_t slot) {
+      return cells_[slot].load(std::memory_order_relaxed);
+    };
+    DecodeCounters out;
+    for (std::size_t i = 0; i < DecodeCounters::FIELD_KINDS; i++) {
+      out.lines[i] = load(i);
+    }
+    out.unknown_lines         = load(util::to_underlying(Counter::UnknownLines));
+    out.bytes_scanned         = load(util::to_underlying(Counter::BytesScanned));
+    out.estimated_allocations = load(util::to_underlying(Counter::EstimatedAllocations));
+    out.exceptions            = load(util::to_underlying(Counter::Exceptions));
+    for (std::size_t i = 0; i < DecodeCounters::PHASES; i++) {
+      out.phase_ns[i] = load(util::to_underlying(Counter::FirstPhase) + i);
     }
+    return out;
   }
 
-  if (info.item.has_value()) {
-    out.append(" @ ");
-    out.append(info.item.value());
-  }
+private:
+  std::array<std::atomic<std::uint64_t>, SLOTS> cells_{};
+};
 
-  return out;
-}
+// Every thread's counters, so they can be totalled. Counters of exited threads are folded into a
+// running total rather than lost
+class CounterRegistry {
+public:
+  [[nodiscard]] static CounterRegistry &instance() {
+    static CounterRegistry registry;
+    return registry;
+  }
 
-[[nodiscard]] inline SpeciesLineInfo decode_name_line(const std::string &line) {
-  SpeciesLineInfo out;
+  void attach(const ThreadCounters &counters) {
+    const std::lock_guard lock{mutex_};
+    live_.push_back(&counters);
+  }
 
-  // Line has at least one open paren; could be gender, nickname + species, or random value
-  if (util::contains(line, " (")) {
-    std::string species_and_nickname;
-    // The final occurrence of an (M) or (F) must be a gender indicator
-    if (util::contains(line, "(M)") || util::contains(line, "(F)")) {
-      // The final combination of a potential gender marker and item marker MUST be interpreted as such
-      if (util::contains(line, "(M) @ ")) {
-        out.gender = Gender::M;
-        auto parts = util::split(line, "(M) @ ");
-        out.item   = util::trim(parts.back());
-        parts.pop_back();
-        species_and_nickname = util::join(parts, "(F) @ ");
-      } else if (util::contains(line, "(F) @ ")) {
-        out.gender = Gender::F;
-        auto parts = util::split(line, "(F) @ ");
-        out.item   = util::trim(parts.back());
-        parts.pop_back();
-        species_and_nickname = util::join(parts, "(F) @ ");
-      } else {
-        // There is no item marker, so the final gender marker must be interpreted as the canonical
-        // gender marker and the rest of the string must contain the species and maybe a nickname
-        out.gender                  = util::contains(line, "(M)") ? Gender::M : Gender::F;
-        const auto gender_substring = std::string{out.gender.value() == Gender::M ? "(M)" : "(F)"};
-        auto parts                  = util::split(line, gender_substring);
-        parts.pop_back();
-        species_and_nickname = util::join(parts, gender_substring);
-      }
-    } else {
-      // An lparen is present but a gender marker isn't; try to
-      // consume a potential item term and use the rest of the string as a
-      // species + nickname
-      auto names_and_maybe_item = util::split(line, " @ ");
-      if (names_and_maybe_item.size() > 1) {
-        out.item = util::trim(names_and_maybe_item.back());
-        names_and_maybe_item.pop_back();
-      }
-      species_and_nickname = util::join(names_and_maybe_item, " @ ");
-    }
-    // If the species and possible nickname string extracted contains an
-    // lparen there might still be a nickname here
-    species_and_nickname = util::trim(species_and_nickname);
-    if (util::contains(species_and_nickname, " (")) {
-      // If any matching rparen exists then this string has a
-      // nickname and a species
-      const auto lparen = species_and_nickname.find(std::string{" ("});
-      const auto rparen = species_and_nickname.rfind(std::string{")"});
-      if ((rparen != std::string::npos) && (rparen > lparen)) {
-        if (rparen != (species_and_nickname.size() - 1)) {
-          throw std::runtime_error{"Malformed nickname and species data"};
-        }
-        auto parts = util::split(species_and_nickname, " (");
-        assert(parts.size() > 1);
-        out.nickname = util::trim(parts.front());
-        parts.erase(parts.begin());
-        out.species = util::join(parts, " (");
-        out.species = util::trim(out.species.substr(0, out.species.size() - 1)); // Remove last rparen
-      } else {
-        out.species = util::trim(species_and_nickname);
-      }
-    } else {
-      out.species = util::trim(species_and_nickname);
-    }
+  void detach(const ThreadCounters &counters) {
+    const std::lock_guard lock{mutex_};
+    retired_ += counters.snapshot();
+    live_.erase(std::find(live_.begin(), live_.end(), &counters));
+  }
 
-  } else {
-    // No lparens means there can only be a species name and item
-    auto species_and_maybe_item = util::split(line, " @ ");
-    if (species_and_maybe_item.size() > 1) {
-      out.item = util::trim(species_and_maybe_item.back());
-      species_and_maybe_item.pop_back();
+  [[nodiscard]] DecodeCounters total() {
+    const std::lock_guard lock{mutex_};
+    auto out = retired_;
+    for (const auto *counters : live_) {
+      out += counters->snapshot();
     }
-    out.species = util::trim(util::join(species_and_maybe_item, " @ "));
+    return out;
   }
 
-  return out;
+private:
+  std::mutex mutex_;
+  std::vector<const ThreadCounters *> live_;
+  DecodeCounters retired_;
+};
+
+[[nodiscard]] inline ThreadCounters &thread_counters() {
+  struct Registered {
+    ThreadCounters counters;
+    Registered() {
+      CounterRegistry::instance().attach(counters);
+    }
+    Registered(const Registered &)            = delete;
+    Registered &operator=(const Registered &) = delete;
+    ~Registered() {
+      CounterRegistry::instance().detach(counters);
+    }
+  };
+  thread_local Registered registered;
+  return registered.counters;
 }
 
-[[nodiscard]] inline std::string encode_ability_line(const std::string &ability) {
-  return encode_string_line(ability, "Ability:");
+inline void count(std::size_t slot, std::uint64_t amount = 1) noexcept {
+  thread_counters().add(slot, amount);
 }
 
-[[nodiscard]] inline std::string decode_ability_line(const std::string &line) {
-  auto value = decode_string_line(line, "Ability:");
-  if (value.empty()) {
-    throw std::runtime_error{"Pokemon Ability line must contain a value"};
+// Adds the time between its construction and destruction to phase
+class PhaseTimer {
+public:
+  explicit PhaseTimer(DecodePhase phase) noexcept : phase_{phase}, start_{std::chrono::steady_clock::now()} {}
+  PhaseTimer(const PhaseTimer &)            = delete;
+  PhaseTimer &operator=(const PhaseTimer &) = delete;
+  ~PhaseTimer() {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+    count(util::to_underlying(Counter::FirstPhase) + util::to_underlying(phase_), static_cast<std::uint64_t>(elapsed.count()));
   }
-  return value;
-}
 
-[[nodiscard]] inline std::string encode_level_line(std::size_t level) {
-  assert(level <= static_cast<std::size_t>(std::numeric_limits<int>::max()));
-  return encode_number_line(static_cast<int>(level), "Level:");
-}
+private:
+  DecodePhase phase_;
+  std::chrono::steady_clock::time_point start_;
+};
 
-[[nodiscard]] inline std::size_t decode_level_line(const std::string &line) {
-  const auto value = decode_number_line(line, "Level:");
-  if (value < 1) {
-    throw std::runtime_error{"Pokemon Level cannot be less than 0"};
-  }
-  return static_cast<std::size_t>(value);
-}
+#else
 
-[[nodiscard]] inline std::string encode_shiny_line(bool shiny) {
-  return encode_bool_line(shiny, "Shiny:");
-}
+constexpr void count(std::size_t, std::uint64_t = 1) noexcept {}
 
-[[nodiscard]] inline bool decode_shiny_line(const std::string &line) {
-  try {
-    return decode_bool_line(line, "Shiny:");
-  } catch ([[maybe_unused]] const std::runtime_error &e) {
-    throw std::runtime_error{R"(Pokemon Shiny line data must be "Yes" or "No")"};
-  }
+class PhaseTimer {
+public:
+  explicit constexpr PhaseTimer(DecodePhase) noexcept {}
+};
+
+#endif
+
+inline void count(FieldKind kind) noexcept {
+  count(util::to_underlying(kind));
+}
+
+inline void count(Counter counter, std::uint64_t amount = 1) noexcept {
+  count(util::to_underlying(counter), amount);
+}
+
+// Counts an allocation if container has to grow to hold size elements
+template <typename Container>
+void count_growth(const Container &container, std::size_t size) noexcept {
+  if constexpr (DECODE_INSTRUMENTED) {
+    if (size > container.capacity()) {
+      count(Counter::EstimatedAllocations);
+    }
+  }
+}
+
+// Counts an allocation if a new string has to be allocated to hold size characters
+inline void count_new_string(std::size_t size) noexcept {
+  if constexpr (DECODE_INSTRUMENTED) {
+    if (size > std::string{}.capacity()) {
+      count(Counter::EstimatedAllocations);
+    }
+  }
+}
+
+// Calls fn with the exception the throwing API reports code as, keeping the exception types it has
+// always used
+template <typename Fn>
+decltype(auto) with_decode_exception(DecodeErrc code, Fn &&fn) {
+  const auto message = std::string{decode_error_message(code)};
+  switch (code) {
+  case DecodeErrc::MalformedInteger:
+    return fn(std::invalid_argument{message});
+  case DecodeErrc::IntegerOutOfRange:
+    return fn(std::out_of_range{message});
+  case DecodeErrc::TooManyMoves:
+    return fn(domain_bound_error{message});
+  default:
+    return fn(std::runtime_error{message});
+  }
+}
+
+[[noreturn]] inline void throw_decode_error(DecodeErrc code) {
+  count(Counter::Exceptions);
+  with_decode_exception(code, [](const auto &error) {
+    throw error;
+  });
+  std::abort();
+}
+
+[[nodiscard]] inline std::exception_ptr make_decode_exception(DecodeErrc code) {
+  return with_decode_exception(code, [](const auto &error) {
+    return std::make_exception_ptr(error);
+  });
+}
+
+} // namespace detail
+
+// Counters of every decode made on the calling thread
+[[nodiscard]] inline DecodeCounters thread_decode_counters() {
+#if NGL_POKEPASTE_INSTRUMENT
+  return detail::thread_counters().snapshot();
+#else
+  return {};
+#endif
+}
+
+// Counters of every decode made on any thread, including threads that have since exited
+[[nodiscard]] inline DecodeCounters total_decode_counters() {
+#if NGL_POKEPASTE_INSTRUMENT
+  return detail::CounterRegistry::instance().total();
+#else
+  return {};
+#endif
+}
+
+// Handle to a string interned in a SymbolTable. Only meaningful together with the table it came from
+enum class Symbol : std::uint32_t {};
+
+// Deduplicating string store shared by any number of decodes, so repeated names across pastes are
+// kept once and compared as integers. Safe to use from several threads at once
+class SymbolTable {
+public:
+  SymbolTable()                               = default;
+  SymbolTable(const SymbolTable &)            = delete;
+  SymbolTable &operator=(const SymbolTable &) = delete;
+
+  // Returns the symbol for text, adding it if it hasn't been seen yet
+  [[nodiscard]] Symbol intern(std::string_view text) {
+    if (const auto found = find(text)) {
+      return found.value();
+    }
+    const std::unique_lock lock{mutex_};
+    // Another thread may have added it between the two locks
+    if (const auto it = symbols_.find(text); it != symbols_.end()) {
+      return it->second;
+    }
+    // Keeps every symbol below the largest std::uint32_t, so the cast below can never wrap
+    if (texts_.size() >= std::numeric_limits<std::uint32_t>::max()) {
+      throw domain_bound_error{"SymbolTable cannot hold more than 2^32 - 1 symbols"};
+    }
+    const auto symbol = Symbol{static_cast<std::uint32_t>(texts_.size())};
+    // Deque elements never move, so the views used as keys stay valid as the table grows
+    const std::string_view stored = texts_.emplace_back(text);
+    symbols_.emplace(stored, symbol);
+    return symbol;
+  }
+
+  [[nodiscard]] std::optional<Symbol> find(std::string_view text) const {
+    const std::shared_lock lock{mutex_};
+    if (const auto it = symbols_.find(text); it != symbols_.end()) {
+      return it->second;
+    }
+    return std::nullopt;
+  }
+
+  // The returned view stays valid for the lifetime of the table
+  [[nodiscard]] std::string_view text(Symbol symbol) const {
+    const std::shared_lock lock{mutex_};
+    const auto index = util::to_underlying(symbol);
+    if (index >= texts_.size()) {
+      throw domain_bound_error{"Symbol is not in this SymbolTable"};
+    }
+    return texts_[index];
+  }
+
+  [[nodiscard]] std::size_t size() const {
+    const std::shared_lock lock{mutex_};
+    return texts_.size();
+  }
+
+private:
+  mutable std::shared_mutex mutex_;
+  std::deque<std::string> texts_;
+  std::unordered_map<std::string_view, Symbol> symbols_;
+};
+
+// Pokemon whose names are symbols in a SymbolTable, which must outlive it
+struct InternedPokemon {
+  std::optional<Symbol> nickname = std::nullopt;
+  Symbol species{};
+  std::optional<Gender> gender = std::nullopt;
+  std::optional<Symbol> item   = std::nullopt;
+
+  // showdown import/export order
+  Symbol ability{};
+  std::optional<std::size_t> level;
+  bool shiny                = false;
+  std::size_t happiness     = Pokemon::DEFAULT_HAPPINESS;
+  std::size_t dynamax_level = Pokemon::DEFAULT_DYNAMAX_LEVEL;
+  bool gigantamax           = false;
+  std::optional<Symbol> tera_type;
+  Pokemon::Stats evs;
+  std::optional<Symbol> nature;
+  Pokemon::Stats ivs = Pokemon::DEFAULT_IVS;
+  util::SmallVector<Symbol, Pokemon::INLINE_MOVES> moves;
+
+  [[nodiscard]] bool operator==(const InternedPokemon &) const                  = default;
+  [[nodiscard]] std::strong_ordering operator<=>(const InternedPokemon &) const = default;
+};
+
+using InternedPokePaste = std::vector<InternedPokemon>;
+
+namespace pmr {
+
+// Pokemon whose strings and move list are allocated from a std::pmr::memory_resource, so a decoded
+// paste can live in a per-request arena and be released along with it. Allocator aware, so a
+// pmr::PokePaste hands its resource down to every Pokemon constructed in it
+struct Pokemon {
+  using allocator_type = std::pmr::polymorphic_allocator<>;
+  using Stats          = pokepaste::Pokemon::Stats;
+
+  std::optional<std::pmr::string> nickname = std::nullopt;
+  std::pmr::string species;
+  std::optional<Gender> gender         = std::nullopt;
+  std::optional<std::pmr::string> item = std::nullopt;
+
+  // showdown import/export order
+  std::pmr::string ability;
+  std::optional<std::size_t> level;
+  bool shiny                = false;
+  std::size_t happiness     = pokepaste::Pokemon::DEFAULT_HAPPINESS;
+  std::size_t dynamax_level = pokepaste::Pokemon::DEFAULT_DYNAMAX_LEVEL;
+  bool gigantamax           = false;
+  std::optional<std::pmr::string> tera_type;
+  Stats evs;
+  std::optional<std::pmr::string> nature;
+  Stats ivs = pokepaste::Pokemon::DEFAULT_IVS;
+  std::pmr::vector<std::pmr::string> moves;
+
+  Pokemon() = default;
+
+  explicit Pokemon(allocator_type allocator) : species{allocator}, ability{allocator}, moves{allocator} {}
+
+  Pokemon(const Pokemon &other, allocator_type allocator) : Pokemon{allocator} {
+    assign(other);
+  }
+
+  Pokemon(Pokemon &&other, allocator_type allocator) : Pokemon{allocator} {
+    if (other.get_allocator() == allocator) {
+      *this = std::move(other);
+    } else {
+      assign(other);
+    }
+  }
+
+  Pokemon(const Pokemon &)            = default;
+  Pokemon(Pokemon &&)                 = default;
+  Pokemon &operator=(const Pokemon &) = default;
+  Pokemon &operator=(Pokemon &&)      = default;
+  ~Pokemon()                          = default;
+
+  [[nodiscard]] allocator_type get_allocator() const noexcept {
+    return species.get_allocator();
+  }
+
+  [[nodiscard]] bool operator==(const Pokemon &) const                  = default;
+  [[nodiscard]] std::strong_ordering operator<=>(const Pokemon &) const = default;
+
+private:
+  // Copies other's values into storage from this Pokemon's own resource
+  void assign(const Pokemon &other) {
+    const auto text = [&](const std::optional<std::pmr::string> &value) -> std::optional<std::pmr::string> {
+      if (!value.has_value()) {
+        return std::nullopt;
+      }
+      return std::pmr::string{value.value(), get_allocator()};
+    };
+    nickname      = text(other.nickname);
+    species       = other.species;
+    gender        = other.gender;
+    item          = text(other.item);
+    ability       = other.ability;
+    level         = other.level;
+    shiny         = other.shiny;
+    happiness     = other.happiness;
+    dynamax_level = other.dynamax_level;
+    gigantamax    = other.gigantamax;
+    tera_type     = text(other.tera_type);
+    evs           = other.evs;
+    nature        = text(other.nature);
+    ivs           = other.ivs;
+    moves.assign(other.moves.begin(), other.moves.end());
+  }
+};
+
+using PokePaste = std::pmr::vector<Pokemon>;
+
+} // namespace pmr
+
+namespace detail {
+
+// PokemonView without its move limit, which CompactPokemon is packed from and read back through
+struct BorrowedPokemon {
+  std::optional<std::string_view> nickname = std::nullopt;
+  std::string_view species;
+  std::optional<Gender> gender         = std::nullopt;
+  std::optional<std::string_view> item = std::nullopt;
+
+  std::string_view ability;
+  std::optional<std::size_t> level;
+  bool shiny                = false;
+  std::size_t happiness     = Pokemon::DEFAULT_HAPPINESS;
+  std::size_t dynamax_level = Pokemon::DEFAULT_DYNAMAX_LEVEL;
+  bool gigantamax           = false;
+  std::optional<std::string_view> tera_type;
+  Pokemon::Stats evs;
+  std::optional<std::string_view> nature;
+  Pokemon::Stats ivs = Pokemon::DEFAULT_IVS;
+  util::SmallVector<std::string_view, Pokemon::INLINE_MOVES> moves;
+};
+
+} // namespace detail
+
+// Pokemon packed for keeping millions of them resident. Every string lives back to back in one buffer
+// addressed by 16-bit offsets, numbers are narrowed to 16 bits and the booleans, the gender and which
+// optionals are present are packed into flag bits. Converting from a Pokemon throws domain_bound_error
+// if it doesn't fit, rather than losing data
+class CompactPokemon {
+public:
+  struct Stats {
+    std::uint16_t hp = 0, atk = 0, def = 0, spatk = 0, spdef = 0, spd = 0;
+    [[nodiscard]] bool operator==(const Stats &) const noexcept                  = default;
+    [[nodiscard]] std::strong_ordering operator<=>(const Stats &) const noexcept = default;
+  };
+
+  CompactPokemon() = default;
+
+  explicit CompactPokemon(const Pokemon &pokemon) {
+    pack(pokemon);
+  }
+
+  explicit CompactPokemon(const detail::BorrowedPokemon &pokemon) {
+    pack(pokemon);
+  }
+
+  [[nodiscard]] std::optional<std::string_view> nickname() const {
+    return optional_text(NICKNAME, HAS_NICKNAME);
+  }
+  [[nodiscard]] std::string_view species() const {
+    return text(SPECIES);
+  }
+  [[nodiscard]] std::optional<Gender> gender() const noexcept {
+    if (!has(HAS_GENDER)) {
+      return std::nullopt;
+    }
+    return has(FEMALE) ? Gender::F : Gender::M;
+  }
+  [[nodiscard]] std::optional<std::string_view> item() const {
+    return optional_text(ITEM, HAS_ITEM);
+  }
+  [[nodiscard]] std::string_view ability() const {
+    return text(ABILITY);
+  }
+  [[nodiscard]] std::optional<std::size_t> level() const noexcept {
+    if (!has(HAS_LEVEL)) {
+      return std::nullopt;
+    }
+    return level_;
+  }
+  [[nodiscard]] bool shiny() const noexcept {
+    return has(SHINY);
+  }
+  [[nodiscard]] std::size_t happiness() const noexcept {
+    return happiness_;
+  }
+  [[nodiscard]] std::size_t dynamax_level() const noexcept {
+    return dynamax_level_;
+  }
+  [[nodiscard]] bool gigantamax() const noexcept {
+    return has(GIGANTAMAX);
+  }
+  [[nodiscard]] std::optional<std::string_view> tera_type() const {
+    return optional_text(TERA_TYPE, HAS_TERA_TYPE);
+  }
+  [[nodiscard]] Pokemon::Stats evs() const noexcept {
+    return widen(evs_);
+  }
+  [[nodiscard]] std::optional<std::string_view> nature() const {
+    return optional_text(NATURE, HAS_NATURE);
+  }
+  [[nodiscard]] Pokemon::Stats ivs() const noexcept {
+    return widen(ivs_);
+  }
+  [[nodiscard]] std::size_t move_count() const noexcept {
+    return move_count_;
+  }
+  // Moves are stored as one list, so this walks the moves before index
+  [[nodiscard]] std::string_view move(std::size_t index) const {
+    if (index >= move_count_) {
+      throw std::out_of_range{"CompactPokemon move index out of range"};
+    }
+    auto moves = std::string_view{text_}.substr(ends_[NATURE]);
+    for (; index > 0; index--) {
+      moves.remove_prefix(moves.find('\n') + 1);
+    }
+    return moves.substr(0, moves.find('\n'));
+  }
+
+  // The returned views refer into this CompactPokemon
+  [[nodiscard]] detail::BorrowedPokemon borrow() const {
+    detail::BorrowedPokemon out;
+    out.nickname      = nickname();
+    out.species       = species();
+    out.gender        = gender();
+    out.item          = item();
+    out.ability       = ability();
+    out.level         = level();
+    out.shiny         = shiny();
+    out.happiness     = happiness();
+    out.dynamax_level = dynamax_level();
+    out.gigantamax    = gigantamax();
+    out.tera_type     = tera_type();
+    out.evs           = evs();
+    out.nature        = nature();
+    out.ivs           = ivs();
+    out.moves.reserve(move_count_);
+    auto moves = std::string_view{text_}.substr(ends_[NATURE]);
+    for (std::size_t i = 0; i < move_count_; i++) {
+      const auto end = moves.find('\n');
+      out.moves.push_back(moves.substr(0, end));
+      moves.remove_prefix(end + 1);
+    }
+    return out;
+  }
+
+  [[nodiscard]] Pokemon to_owned() const {
+    const auto view = borrow();
+    Pokemon out;
+    out.nickname      = view.nickname;
+    out.species       = view.species;
+    out.gender        = view.gender;
+    out.item          = view.item;
+    out.ability       = view.ability;
+    out.level         = view.level;
+    out.shiny         = view.shiny;
+    out.happiness     = view.happiness;
+    out.dynamax_level = view.dynamax_level;
+    out.gigantamax    = view.gigantamax;
+    out.tera_type     = view.tera_type;
+    out.evs           = view.evs;
+    out.nature        = view.nature;
+    out.ivs           = view.ivs;
+    out.moves.assign(view.moves.begin(), view.moves.end());
+    return out;
+  }
+
+  [[nodiscard]] bool operator==(const CompactPokemon &) const                  = default;
+  [[nodiscard]] std::strong_ordering operator<=>(const CompactPokemon &) const = default;
+
+private:
+  // Text fields in the order they are stored, each ending at ends_[field]. The moves follow the last
+  // one, each terminated by a newline
+  enum TextField : std::uint8_t {
+    NICKNAME,
+    SPECIES,
+    ITEM,
+    ABILITY,
+    TERA_TYPE,
+    NATURE,
+    NUM_TEXT_FIELDS
+  };
+
+  enum Flag : std::uint16_t {
+    HAS_NICKNAME  = 1U << 0U,
+    HAS_ITEM      = 1U << 1U,
+    HAS_LEVEL     = 1U << 2U,
+    HAS_TERA_TYPE = 1U << 3U,
+    HAS_NATURE    = 1U << 4U,
+    HAS_GENDER    = 1U << 5U,
+    FEMALE        = 1U << 6U,
+    SHINY         = 1U << 7U,
+    GIGANTAMAX    = 1U << 8U
+  };
+
+  [[nodiscard]] bool has(Flag flag) const noexcept {
+    return (flags_ & flag) != 0;
+  }
+
+  [[nodiscard]] std::string_view text(TextField field) const {
+    const std::size_t begin = (field == NICKNAME) ? 0 : ends_[field - 1];
+    return std::string_view{text_}.substr(begin, ends_[field] - begin);
+  }
+
+  [[nodiscard]] std::optional<std::string_view> optional_text(TextField field, Flag flag) const {
+    if (!has(flag)) {
+      return std::nullopt;
+    }
+    return text(field);
+  }
+
+  [[nodiscard]] static std::uint16_t narrow(std::size_t value) {
+    if (value > std::numeric_limits<std::uint16_t>::max()) {
+      throw domain_bound_error{"CompactPokemon cannot hold numbers above 65535"};
+    }
+    return static_cast<std::uint16_t>(value);
+  }
+
+  [[nodiscard]] static Stats narrow(const Pokemon::Stats &stats) {
+    return {narrow(stats.hp), narrow(stats.atk), narrow(stats.def), narrow(stats.spatk), narrow(stats.spdef), narrow(stats.spd)};
+  }
+
+  [[nodiscard]] static Pokemon::Stats widen(const Stats &stats) noexcept {
+    return {stats.hp, stats.atk, stats.def, stats.spatk, stats.spdef, stats.spd};
+  }
+
+  template <typename PokemonT>
+  void pack(const PokemonT &pokemon) {
+    const auto optional_size = [](const auto &value) -> std::size_t {
+      return value.has_value() ? std::string_view{value.value()}.size() : 0;
+    };
+    auto size = optional_size(pokemon.nickname) + std::string_view{pokemon.species}.size() + optional_size(pokemon.item) + std::string_view{pokemon.ability}.size() + optional_size(pokemon.tera_type) + optional_size(pokemon.nature);
+    for (const auto &move : pokemon.moves) {
+      size += std::string_view{move}.size() + 1;
+    }
+    if (size > std::numeric_limits<std::uint16_t>::max()) {
+      throw domain_bound_error{"CompactPokemon cannot hold more than 65535 bytes of text"};
+    }
+    text_.reserve(size);
+
+    std::size_t field      = 0;
+    const auto append_text = [&](std::string_view value) {
+      text_.append(value);
+      ends_[field++] = static_cast<std::uint16_t>(text_.size());
+    };
+    const auto append_optional = [&](const auto &value, Flag flag) {
+      if (value.has_value()) {
+        flags_ |= flag;
+        append_text(value.value());
+      } else {
+        append_text({});
+      }
+    };
+    append_optional(pokemon.nickname, HAS_NICKNAME);
+    append_text(pokemon.species);
+    append_optional(pokemon.item, HAS_ITEM);
+    append_text(pokemon.ability);
+    append_optional(pokemon.tera_type, HAS_TERA_TYPE);
+    append_optional(pokemon.nature, HAS_NATURE);
+
+    if (pokemon.moves.size() > std::numeric_limits<std::uint16_t>::max()) {
+      throw domain_bound_error{"CompactPokemon cannot hold more than 65535 moves"};
+    }
+    for (const auto &move : pokemon.moves) {
+      if (std::string_view{move}.find('\n') != std::string_view::npos) {
+        throw domain_bound_error{"CompactPokemon moves cannot contain newlines"};
+      }
+      text_.append(move);
+      text_.push_back('\n');
+    }
+    move_count_ = static_cast<std::uint16_t>(pokemon.moves.size());
+
+    if (pokemon.gender.has_value()) {
+      flags_ |= HAS_GENDER;
+      if (pokemon.gender.value() == Gender::F) {
+        flags_ |= FEMALE;
+      }
+    }
+    if (pokemon.level.has_value()) {
+      flags_ |= HAS_LEVEL;
+      level_ = narrow(pokemon.level.value());
+    }
+    if (pokemon.shiny) {
+      flags_ |= SHINY;
+    }
+    if (pokemon.gigantamax) {
+      flags_ |= GIGANTAMAX;
+    }
+    happiness_     = narrow(pokemon.happiness);
+    dynamax_level_ = narrow(pokemon.dynamax_level);
+    evs_           = narrow(pokemon.evs);
+    ivs_           = narrow(pokemon.ivs);
+  }
+
+  std::string text_;
+  std::array<std::uint16_t, NUM_TEXT_FIELDS> ends_{};
+  Stats evs_;
+  Stats ivs_                   = narrow(Pokemon::DEFAULT_IVS);
+  std::uint16_t level_         = 0;
+  std::uint16_t happiness_     = Pokemon::DEFAULT_HAPPINESS;
+  std::uint16_t dynamax_level_ = Pokemon::DEFAULT_DYNAMAX_LEVEL;
+  std::uint16_t move_count_    = 0;
+  std::uint16_t flags_         = 0;
+};
+
+using CompactPokePaste = std::vector<CompactPokemon>;
+
+namespace detail {
+
+struct SpeciesLineInfo {
+  std::optional<std::string> nickname;
+  std::string species;
+  std::optional<Gender> gender;
+  std::optional<std::string> item;
+  [[nodiscard]] bool operator==(
+    const SpeciesLineInfo &
+  ) const noexcept = default;
+  [[nodiscard]] std::strong_ordering operator<=>(
+    const SpeciesLineInfo &
+  ) const noexcept = default;
+};
+
+// SpeciesLineInfo whose strings refer into the decoded line
+struct SpeciesLineView {
+  std::optional<std::string_view> nickname;
+  std::string_view species;
+  std::optional<Gender> gender;
+  std::optional<std::string_view> item;
+  [[nodiscard]] bool operator==(
+    const SpeciesLineView &
+  ) const noexcept = default;
+  [[nodiscard]] std::strong_ordering operator<=>(
+    const SpeciesLineView &
+  ) const noexcept = default;
+};
+
+struct NewlineScan {
+  // Number of newline offsets written
+  std::size_t count = 0;
+  // Every newline before this offset has been recorded
+  std::size_t end = 0;
+};
+
+// Offsets are stored relative to where the scan started, so a single scan never covers more than this
+constexpr std::size_t MAX_SCAN_WINDOW = std::numeric_limits<std::uint32_t>::max();
+
+// Records the offsets of '\n' in data starting at from, relative to from, until out is full
+[[nodiscard]] inline NewlineScan scan_newlines_scalar(std::string_view data, std::size_t from, std::span<std::uint32_t> out) noexcept {
+  const auto limit  = std::min(data.size(), from + MAX_SCAN_WINDOW);
+  std::size_t count = 0;
+  for (auto pos = from; pos < limit; pos++) {
+    if (data[pos] == '\n') {
+      out[count++] = static_cast<std::uint32_t>(pos - from);
+      if (count == out.size()) {
+        return {count, pos + 1};
+      }
+    }
+  }
+  return {count, limit};
+}
+
+#if NGL_POKEPASTE_HAS_X86_SIMD
+
+// Records the newlines flagged in the bitmask of the width bytes at pos. Returns true once out is full,
+// in which case scan.end is set just past the last newline recorded
+[[nodiscard]] inline bool record_newline_mask(std::uint32_t mask, std::size_t pos, std::size_t from, std::span<std::uint32_t> out, NewlineScan &scan) noexcept {
+  while (mask != 0) {
+    const auto newline = pos + static_cast<std::size_t>(std::countr_zero(mask));
+    out[scan.count++]  = static_cast<std::uint32_t>(newline - from);
+    if (scan.count == out.size()) {
+      scan.end = newline + 1;
+      return true;
+    }
+    mask &= mask - 1;
+  }
+  return false;
+}
+
+// Scans the tail too short for a full vector, offsetting the results to be relative to from
+[[nodiscard]] inline NewlineScan scan_newlines_tail(std::string_view data, std::size_t pos, std::size_t from, std::span<std::uint32_t> out, NewlineScan scan) noexcept {
+  const auto tail = scan_newlines_scalar(data, pos, out.subspan(scan.count));
+  for (std::size_t i = scan.count; i < (scan.count + tail.count); i++) {
+    out[i] += static_cast<std::uint32_t>(pos - from);
+  }
+  return {scan.count + tail.count, tail.end};
+}
+
+[[nodiscard]] inline NewlineScan scan_newlines_sse2(std::string_view data, std::size_t from, std::span<std::uint32_t> out) noexcept {
+  data               = data.substr(0, std::min(data.size(), from + MAX_SCAN_WINDOW));
+  const auto newline = _mm_set1_epi8('\n');
+  NewlineScan scan;
+  auto pos = from;
+  for (; (pos + sizeof(__m128i)) <= data.size(); pos += sizeof(__m128i)) {
+    const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data.data() + pos)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto mask  = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+    if (record_newline_mask(mask, pos, from, out, scan)) {
+      return scan;
+    }
+  }
+  return scan_newlines_tail(data, pos, from, out, scan);
+}
+
+__attribute__((target("avx2"))) inline NewlineScan scan_newlines_avx2(std::string_view data, std::size_t from, std::span<std::uint32_t> out) noexcept {
+  data               = data.substr(0, std::min(data.size(), from + MAX_SCAN_WINDOW));
+  const auto newline = _mm256_set1_epi8('\n');
+  NewlineScan scan;
+  auto pos = from;
+  for (; (pos + sizeof(__m256i)) <= data.size(); pos += sizeof(__m256i)) {
+    const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data.data() + pos)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto mask  = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline)));
+    if (record_newline_mask(mask, pos, from, out, scan)) {
+      return scan;
+    }
+  }
+  return scan_newlines_tail(data, pos, from, out, scan);
+}
+
+#endif
+
+} // namespace detail
+
+// Implementation used to find line boundaries while decoding. Auto picks the widest one the CPU supports
+enum class LineScanner : uint8_t {
+  Auto,
+  Scalar,
+  SSE2,
+  AVX2
+};
+
+[[nodiscard]] inline bool line_scanner_supported(LineScanner scanner) noexcept {
+  switch (scanner) {
+  case LineScanner::Auto:
+  case LineScanner::Scalar:
+    return true;
+#if NGL_POKEPASTE_HAS_X86_SIMD
+  case LineScanner::SSE2:
+    return true;
+  case LineScanner::AVX2:
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+  default:
+    return false;
+  }
+}
+
+namespace detail {
+
+inline std::atomic<LineScanner> line_scanner_setting = LineScanner::Auto; // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+} // namespace detail
+
+// Lets benchmarks pin a particular scanner; throws domain_bound_error if this build or CPU lacks it
+inline void set_line_scanner(LineScanner scanner) {
+  if (!line_scanner_supported(scanner)) {
+    throw domain_bound_error{"Line scanner is not supported on this platform"};
+  }
+  detail::line_scanner_setting.store(scanner, std::memory_order_relaxed);
+}
+
+// The scanner decoding currently uses, with Auto resolved
+[[nodiscard]] inline LineScanner active_line_scanner() noexcept {
+  const auto scanner = detail::line_scanner_setting.load(std::memory_order_relaxed);
+  if (scanner != LineScanner::Auto) {
+    return scanner;
+  }
+  static const auto best = line_scanner_supported(LineScanner::AVX2)   ? LineScanner::AVX2
+                           : line_scanner_supported(LineScanner::SSE2) ? LineScanner::SSE2
+                                                                       : LineScanner::Scalar;
+  return best;
+}
+
+namespace detail {
+
+using NewlineScanner = NewlineScan (*)(std::string_view, std::size_t, std::span<std::uint32_t>) noexcept;
+
+[[nodiscard]] inline NewlineScanner newline_scanner() noexcept {
+  switch (active_line_scanner()) {
+#if NGL_POKEPASTE_HAS_X86_SIMD
+  case LineScanner::SSE2:
+    return scan_newlines_sse2;
+  case LineScanner::AVX2:
+    return scan_newlines_avx2;
+#endif
+  default:
+    return scan_newlines_scalar;
+  }
+}
+
+// Yields the lines of a paste without their LF or CRLF terminators. Newlines are located a batch at a
+// time by the active line scanner into a small fixed index, so reading lines never allocates
+class LineReader {
+public:
+  explicit LineReader(std::string_view data) noexcept : data_{data}, scan_{newline_scanner()} {}
+
+  [[nodiscard]] std::optional<std::string_view> next() noexcept {
+    if (done_) {
+      return std::nullopt;
+    }
+    const PhaseTimer timer{DecodePhase::Split};
+    while ((cursor_ == count_) && (scanned_ < data_.size())) {
+      base_            = scanned_;
+      const auto found = scan_(data_, scanned_, newlines_);
+      count_           = found.count;
+      cursor_          = 0;
+      scanned_         = found.end;
+      count(Counter::BytesScanned, scanned_ - base_);
+    }
+    std::size_t end = data_.size();
+    if (cursor_ < count_) {
+      end = base_ + newlines_[cursor_++];
+    } else {
+      done_ = true;
+    }
+    auto line = data_.substr(position_, end - position_);
+    position_ = end + 1;
+    line_number_++;
+    if (!line.empty() && (line.back() == '\r')) {
+      line.remove_suffix(1);
+    }
+    return line;
+  }
+
+  // 1-based number of the line last returned by next()
+  [[nodiscard]] std::size_t line_number() const noexcept {
+    return line_number_;
+  }
+
+  // Discards lines up to and including the next empty one, which ends the current block
+  void skip_block() noexcept {
+    while (const auto line = next()) {
+      if (line->empty()) {
+        return;
+      }
+    }
+  }
+
+private:
+  std::string_view data_;
+  NewlineScanner scan_;
+  std::array<std::uint32_t, 64> newlines_{};
+  std::size_t base_        = 0;
+  std::size_t count_       = 0;
+  std::size_t cursor_      = 0;
+  std::size_t scanned_     = 0;
+  std::size_t position_    = 0;
+  std::size_t line_number_ = 0;
+  bool done_               = false;
+};
+
+template <typename OutputIt>
+OutputIt write_text(OutputIt out, std::string_view text) {
+  return std::copy(text.begin(), text.end(), out);
+}
+
+// Output iterator that measures what is written through it instead of storing it, including how much
+// whitespace trimming would remove from either end
+class SizeCounter {
+public:
+  using difference_type = std::ptrdiff_t;
+
+  SizeCounter &operator*() noexcept {
+    return *this;
+  }
+  SizeCounter &operator++() noexcept {
+    return *this;
+  }
+  // Returns itself rather than a copy, so the count written through *out++ isn't lost
+  SizeCounter &operator++(int) noexcept {
+    return *this;
+  }
+  SizeCounter &operator=(char c) noexcept {
+    add(std::string_view{&c, 1});
+    return *this;
+  }
+
+  void add(std::string_view text) noexcept {
+    const auto first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) {
+      (seen_text_ ? trailing_ : leading_) += text.size();
+    } else {
+      if (!seen_text_) {
+        leading_ += first;
+      }
+      seen_text_ = true;
+      trailing_  = text.size() - 1 - text.find_last_not_of(" \t\r\n");
+    }
+    size_ += text.size();
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept {
+    return size_;
+  }
+  [[nodiscard]] std::size_t trimmed_size() const noexcept {
+    return seen_text_ ? (size_ - leading_ - trailing_) : 0;
+  }
+
+private:
+  std::size_t size_     = 0;
+  std::size_t leading_  = 0;
+  std::size_t trailing_ = 0;
+  bool seen_text_       = false;
+};
+
+inline SizeCounter write_text(SizeCounter out, std::string_view text) noexcept {
+  out.add(text);
+  return out;
+}
+
+template <typename OutputIt, typename Integer>
+OutputIt write_number(OutputIt out, Integer value) {
+  // digits10 is one short of the digits the widest values need, plus a sign
+  std::array<char, std::numeric_limits<Integer>::digits10 + 2> buffer{};
+  const auto [end, error] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+  assert(error == std::errc{});
+  return write_text(out, std::string_view{buffer.data(), static_cast<std::size_t>(end - buffer.data())});
+}
+
+// Writes a whole "<label><value>" line, label including its separating space
+template <typename OutputIt>
+OutputIt write_labelled_line(OutputIt out, std::string_view label, std::string_view value) {
+  out = write_text(out, label);
+  return write_text(out, util::trim_view(value));
+}
+
+template <typename OutputIt, typename Integer>
+OutputIt write_labelled_number(OutputIt out, std::string_view label, Integer value) {
+  out = write_text(out, label);
+  return write_number(out, value);
+}
+
+template <typename OutputIt>
+OutputIt encode_string_line_to(OutputIt out, std::string_view line, std::string_view prefix) {
+  out    = write_text(out, util::trim_view(prefix));
+  *out++ = ' ';
+  return write_text(out, util::trim_view(line));
+}
+
+[[nodiscard]] inline std::string encode_string_line(std::string_view line, std::string_view prefix) {
+  std::string out;
+  encode_string_line_to(std::back_inserter(out), line, prefix);
+  return out;
+}
+
+[[nodiscard]] inline std::string_view decode_string_line_view(std::string_view line, std::string_view prefix) {
+  assert(util::starts_with(line, prefix));
+  return util::trim_view(line.substr(prefix.size()));
+}
+
+[[nodiscard]] inline std::string decode_string_line(std::string_view line, std::string_view prefix) {
+  return std::string{decode_string_line_view(line, prefix)};
+}
+
+// Why a line failed to decode, and how far into the line the offending text starts
+struct LineError {
+  DecodeErrc code;
+  std::size_t offset = 0;
+};
+
+// Result of the try_decode_*_line functions, which only write their output on success
+using LineStatus = std::optional<LineError>;
+
+inline void check(const LineStatus &status) {
+  if (status.has_value()) {
+    throw_decode_error(status->code);
+  }
+}
+
+// Offset of the first non-whitespace character at or after from, or the end of the line
+[[nodiscard]] constexpr std::size_t value_offset(std::string_view line, std::size_t from) noexcept {
+  const auto pos = line.find_first_not_of(" \t\r\n", from);
+  return (pos == std::string_view::npos) ? line.size() : pos;
+}
+
+[[nodiscard]] inline LineError int_error(std::errc code, std::size_t offset) noexcept {
+  return {(code == std::errc::result_out_of_range) ? DecodeErrc::IntegerOutOfRange : DecodeErrc::MalformedInteger, offset};
+}
+
+template <typename OutputIt>
+OutputIt encode_number_line_to(OutputIt out, int number, std::string_view prefix) {
+  out    = write_text(out, util::trim_view(prefix));
+  *out++ = ' ';
+  return write_number(out, number);
+}
+
+[[nodiscard]] inline std::string encode_number_line(int number, std::string_view prefix) {
+  std::string out;
+  encode_number_line_to(std::back_inserter(out), number, prefix);
+  return out;
+}
+
+[[nodiscard]] inline LineStatus try_decode_number_line(std::string_view line, std::string_view prefix, int &out) noexcept {
+  assert(util::starts_with(line, prefix));
+  const auto code = util::try_to_int(decode_string_line_view(line, prefix), out);
+  if (code != std::errc{}) {
+    return int_error(code, value_offset(line, prefix.size()));
+  }
+  return std::nullopt;
+}
+
+[[nodiscard]] inline int decode_number_line(std::string_view line, std::string_view prefix) {
+  int out = 0;
+  check(try_decode_number_line(line, prefix, out));
+  return out;
+}
+
+// Numbers that must be at least 1, reported as too_low otherwise
+[[nodiscard]] inline LineStatus try_decode_positive_line(std::string_view line, std::string_view prefix, DecodeErrc too_low, std::size_t &out) noexcept {
+  int value = 0;
+  if (const auto status = try_decode_number_line(line, prefix, value)) {
+    return status;
+  }
+  if (value < 1) {
+    return LineError{too_low, value_offset(line, prefix.size())};
+  }
+  out = static_cast<std::size_t>(value);
+  return std::nullopt;
+}
+
+template <typename OutputIt>
+OutputIt encode_bool_line_to(OutputIt out, bool value, std::string_view prefix) {
+  return encode_string_line_to(out, value ? "Yes" : "No", prefix);
+}
+
+[[nodiscard]] inline std::string encode_bool_line(bool value, std::string_view prefix) {
+  std::string out;
+  encode_bool_line_to(std::back_inserter(out), value, prefix);
+  return out;
+}
+
+[[nodiscard]] inline LineStatus try_decode_bool_line(
+  std::string_view line, std::string_view prefix, bool &out, DecodeErrc invalid = DecodeErrc::InvalidBool
+) noexcept {
+  assert(util::starts_with(line, prefix));
+  const auto str = decode_string_line_view(line, prefix);
+  if (util::iequals(str, "yes")) {
+    out = true;
+    return std::nullopt;
+  }
+
+  if (util::iequals(str, "no")) {
+    out = false;
+    return std::nullopt;
+  }
+
+  return LineError{invalid, value_offset(line, prefix.size())};
+}
+
+[[nodiscard]] inline bool decode_bool_line(std::string_view line, std::string_view prefix) {
+  bool out = false;
+  check(try_decode_bool_line(line, prefix, out));
+  return out;
+}
+
+// Pokemon::Stats members in the order stat lines are written in
+constexpr std::array<std::size_t Pokemon::Stats::*, Pokemon::Stats::NUM_STATS> STAT_MEMBERS = {
+  &Pokemon::Stats::hp,
+  &Pokemon::Stats::atk,
+  &Pokemon::Stats::def,
+  &Pokemon::Stats::spatk,
+  &Pokemon::Stats::spdef,
+  &Pokemon::Stats::spd
+};
+
+// What follows each value in a stat line, in STAT_MEMBERS order
+constexpr std::array<std::string_view, Pokemon::Stats::NUM_STATS> STAT_SUFFIXES = {
+  " HP", " Atk", " Def", " SpA", " SpD", " Spe"
+};
+
+template <typename OutputIt>
+OutputIt encode_stat_line_to(
+  OutputIt out,
+  const Pokemon::Stats &stats,
+  std::string_view prefix,
+  const Pokemon::Stats &baseline = {}
+) {
+  out        = write_text(out, util::trim_view(prefix));
+  *out++     = ' ';
+  bool first = true;
+  for (std::size_t i = 0; i < Pokemon::Stats::NUM_STATS; i++) {
+    const auto value = stats.*STAT_MEMBERS[i];
+    if (value == baseline.*STAT_MEMBERS[i]) {
+      continue;
+    }
+    if (!first) {
+      out = write_text(out, " / ");
+    }
+    first = false;
+    out   = write_number(out, value);
+    out   = write_text(out, STAT_SUFFIXES[i]);
+  }
+  return out;
+}
+
+[[nodiscard]] inline std::string encode_stat_line(
+  const Pokemon::Stats &stats,
+  std::string_view prefix,
+  const Pokemon::Stats &baseline = {}
+) {
+  std::string out;
+  encode_stat_line_to(std::back_inserter(out), stats, prefix, baseline);
+  return out;
+}
+
+// Position of a stat in Pokemon::Stats order given its name as written in a stat line, ignoring case
+[[nodiscard]] constexpr std::optional<std::size_t> stat_index(std::string_view name) noexcept {
+  const auto lower = [](char c) {
+    return ((c >= 'A') && (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') : c;
+  };
+  if (name.size() == 2) {
+    if ((lower(name[0]) == 'h') && (lower(name[1]) == 'p')) {
+      return 0;
+    }
+    return std::nullopt;
+  }
+  if (name.size() != 3) {
+    return std::nullopt;
+  }
+  const auto a = lower(name[0]);
+  const auto b = lower(name[1]);
+  const auto c = lower(name[2]);
+  if ((a == 'a') && (b == 't') && (c == 'k')) {
+    return 1;
+  }
+  if ((a == 'd') && (b == 'e') && (c == 'f')) {
+    return 2;
+  }
+  if ((a == 's') && (b == 'p')) {
+    switch (c) {
+    case 'a':
+      return 3;
+    case 'd':
+      return 4;
+    case 'e':
+      return 5;
+    default:
+      break;
+    }
+  }
+  return std::nullopt;
+}
+
+[[nodiscard]] inline LineStatus try_decode_stat_line(
+  std::string_view line, std::string_view prefix, const Pokemon::Stats &default_stats, Pokemon::Stats &out
+) noexcept {
+  const PhaseTimer timer{DecodePhase::Stats};
+  auto body              = decode_string_line_view(line, prefix);
+  const auto body_offset = value_offset(line, prefix.size());
+  if (body.empty()) {
+    return LineError{DecodeErrc::EmptyStats, body_offset};
+  }
+  if (static_cast<std::size_t>(std::ranges::count(body, '/')) >= Pokemon::Stats::NUM_STATS) {
+    return LineError{DecodeErrc::TooManyStats, body_offset};
+  }
+
+  auto stats               = default_stats;
+  std::uint8_t seen        = 0;
+  std::size_t entry_offset = body_offset;
+  while (true) {
+    // Each entry is exactly "<value> <stat>" once trimmed
+    const auto slash = body.find('/');
+    const auto raw   = body.substr(0, slash);
+    const auto entry = util::trim_view(raw);
+    const auto at    = std::min(value_offset(line, entry_offset), entry_offset + raw.size());
+    const auto space = entry.find(' ');
+    if ((space == std::string_view::npos) || (entry.find(' ', space + 1) != std::string_view::npos)) {
+      return LineError{DecodeErrc::MalformedStatEntry, at};
+    }
+    int value = 0;
+    if (const auto code = util::try_to_int(entry.substr(0, space), value); code != std::errc{}) {
+      return int_error(code, at);
+    }
+    if (value < 0) {
+      return LineError{DecodeErrc::NegativeStat, at};
+    }
+    const auto index = stat_index(util::trim_view(entry.substr(space + 1)));
+    if (!index.has_value()) {
+      return LineError{DecodeErrc::UnknownStat, at + space + 1};
+    }
+    const auto bit = static_cast<std::uint8_t>(1U << index.value());
+    if ((seen & bit) != 0) {
+      return LineError{DecodeErrc::DuplicateStat, at};
+    }
+    seen |= bit;
+    stats.*(STAT_MEMBERS[index.value()]) = static_cast<std::size_t>(value);
+    if (slash == std::string_view::npos) {
+      break;
+    }
+    body.remove_prefix(slash + 1);
+    entry_offset += slash + 1;
+  }
+
+  out = stats;
+  return std::nullopt;
+}
+
+[[nodiscard]] inline Pokemon::Stats decode_stat_line(
+  std::string_view line, std::string_view prefix, const Pokemon::Stats &default_stats = {}
+) {
+  Pokemon::Stats out;
+  check(try_decode_stat_line(line, prefix, default_stats, out));
+  return out;
+}
+
+template <typename OutputIt>
+OutputIt encode_name_line_to(OutputIt out, const SpeciesLineView &info) {
+  if (info.nickname.has_value()) {
+    out = write_text(out, info.nickname.value());
+    out = write_text(out, " (");
+    out = write_text(out, info.species);
+    out = write_text(out, ")");
+  } else {
+    out = write_text(out, info.species);
+  }
+
+  if (info.gender.has_value()) {
+    switch (info.gender.value()) {
+    case Gender::M:
+      out = write_text(out, " (M)");
+      break;
+    case Gender::F:
+      out = write_text(out, " (F)");
+      break;
+    default:
+      throw std::runtime_error{"Unreachable"};
+    }
+  }
+
+  if (info.item.has_value()) {
+    out = write_text(out, " @ ");
+    out = write_text(out, info.item.value());
+  }
+
+  return out;
+}
+
+[[nodiscard]] inline std::string encode_name_line(const SpeciesLineView &info) {
+  std::string out;
+  encode_name_line_to(std::back_inserter(out), info);
+  return out;
+}
+
+[[nodiscard]] inline std::string encode_name_line(const SpeciesLineInfo &info) {
+  return encode_name_line(SpeciesLineView{info.nickname, info.species, info.gender, info.item});
+}
+
+// Final occurrence of a name line marker, along with the closest ')' before it, which is where a
+// parenthesised species has to end if the line is cut at that marker
+struct NameLineMarker {
+  std::size_t pos      = std::string_view::npos;
+  std::size_t rparen   = std::string_view::npos;
+  bool awaiting_rparen = false;
+
+  void see(std::size_t at) noexcept {
+    if (pos == std::string_view::npos) {
+      pos             = at;
+      awaiting_rparen = true;
+    }
+  }
+
+  void see_rparen(std::size_t at) noexcept {
+    if (awaiting_rparen) {
+      rparen          = at;
+      awaiting_rparen = false;
+    }
+  }
+
+  [[nodiscard]] bool found() const noexcept {
+    return pos != std::string_view::npos;
+  }
+};
+
+// Single right to left scan over the line. The final gender marker, item marker and the last ')' before
+// each are picked up as they are passed, then the line is cut at whichever marker takes precedence
+[[nodiscard]] inline LineStatus try_decode_name_line_view(std::string_view line, SpeciesLineView &out) noexcept {
+  constexpr auto npos = std::string_view::npos;
+  NameLineMarker male_item, female_item, male, female, item, line_end;
+  line_end.see(line.size());
+  // Item markers can overlap, as in " @ @ ", and the original split based parser only cut at every
+  // other marker in such a chain, so the rightmost chain is tracked to cut where it would have
+  std::size_t item_chain_begin = npos;
+  bool item_chain_open         = false;
+  // Leading whitespace can hide the first " (" from the trimmed species and nickname, so keep two
+  std::array<std::size_t, 2> lparens = {npos, npos};
+
+  for (auto i = line.size(); i-- > 0;) {
+    const auto rest = line.substr(i);
+    switch (line[i]) {
+    case ')':
+      for (auto *marker : {&male_item, &female_item, &male, &female, &item, &line_end}) {
+        marker->see_rparen(i);
+      }
+      break;
+    case '(':
+      if (util::starts_with(rest, "(M)")) {
+        male.see(i);
+        if (util::starts_with(rest, "(M) @ ")) {
+          male_item.see(i);
+        }
+      } else if (util::starts_with(rest, "(F)")) {
+        female.see(i);
+        if (util::starts_with(rest, "(F) @ ")) {
+          female_item.see(i);
+        }
+      }
+      break;
+    case ' ':
+      if (util::starts_with(rest, " (")) {
+        lparens = {i, lparens[0]};
+      } else if (util::starts_with(rest, " @ ")) {
+        if (!item.found()) {
+          item.see(i);
+          item_chain_begin = i;
+          item_chain_open  = true;
+        } else if (item_chain_open && ((i + 2) == item_chain_begin)) {
+          item_chain_begin = i;
+        } else {
+          item_chain_open = false;
+        }
+      }
+      break;
+    default:
+      break;
+    }
+  }
+  if (item.found() && (((item.pos - item_chain_begin) % 4) != 0)) {
+    item.pos -= 2;
+  }
+
+  out                   = SpeciesLineView{};
+  const auto has_lparen = lparens[0] != npos;
+  const auto *cut       = &line_end;
+  // With a " (" present, the final combination of a gender marker and item marker MUST be interpreted
+  // as such, otherwise the final gender marker is the canonical one
+  if (has_lparen && (male.found() || female.found())) {
+    if (male_item.found()) {
+      out.gender = Gender::M;
+      cut        = &male_item;
+    } else if (female_item.found()) {
+      out.gender = Gender::F;
+      cut        = &female_item;
+    }
+    if (cut != &line_end) {
+      out.item = util::trim_view(line.substr(cut->pos + 6));
+    } else {
+      out.gender = male.found() ? Gender::M : Gender::F;
+      cut        = male.found() ? &male : &female;
+    }
+  } else if (item.found()) {
+    out.item = util::trim_view(line.substr(item.pos + 3));
+    cut      = &item;
+  }
+
+  const auto species_and_nickname = util::trim_view(line.substr(0, cut->pos));
+  if (!has_lparen || species_and_nickname.empty()) {
+    out.species = species_and_nickname;
+    return std::nullopt;
+  }
+
+  // If the species and nickname contain an lparen with a matching rparen after it then there is a
+  // nickname and a species
+  const auto begin  = static_cast<std::size_t>(species_and_nickname.data() - line.data());
+  const auto end    = begin + species_and_nickname.size();
+  const auto lparen = (lparens[0] >= begin) ? lparens[0] : lparens[1];
+  const auto rparen = cut->rparen;
+  if ((lparen != npos) && ((lparen + 2) <= end) && (rparen != npos) && (rparen > lparen)) {
+    if (rparen != (end - 1)) {
+      return LineError{DecodeErrc::MalformedName, 0};
+    }
+    out.nickname = util::trim_view(line.substr(0, lparen));
+    out.species  = util::trim_view(line.substr(lparen + 2, rparen - lparen - 2));
+  } else {
+    out.species = species_and_nickname;
+  }
+
+  return std::nullopt;
+}
+
+[[nodiscard]] inline SpeciesLineView decode_name_line_view(std::string_view line) {
+  SpeciesLineView out;
+  check(try_decode_name_line_view(line, out));
+  return out;
+}
+[[nodiscard]] inline SpeciesLineInfo decode_name_line(std::string_view line) {
+  const auto view = decode_name_line_view(line);
+  SpeciesLineInfo out;
+  out.nickname = view.nickname;
+  out.species  = view.species;
+  out.gender   = view.gender;
+  out.item     = view.item;
+  return out;
+}
+
+template <typename OutputIt>
+OutputIt encode_ability_line_to(OutputIt out, std::string_view ability) {
+  return write_labelled_line(out, "Ability: ", ability);
+}
+
+[[nodiscard]] inline std::string encode_ability_line(std::string_view ability) {
+  std::string out;
+  encode_ability_line_to(std::back_inserter(out), ability);
+  return out;
+}
+
+[[nodiscard]] inline LineStatus try_decode_ability_line_view(std::string_view line, std::string_view &out) noexcept {
+  const auto value = decode_string_line_view(line, "Ability:");
+  if (value.empty()) {
+    return LineError{DecodeErrc::EmptyAbility, line.size()};
+  }
+  out = value;
+  return std::nullopt;
+}
+
+[[nodiscard]] inline std::string_view decode_ability_line_view(std::string_view line) {
+  std::string_view out;
+  check(try_decode_ability_line_view(line, out));
+  return out;
+}
+
+[[nodiscard]] inline std::string decode_ability_line(std::string_view line) {
+  return std::string{decode_ability_line_view(line)};
+}
+
+template <typename OutputIt>
+OutputIt encode_level_line_to(OutputIt out, std::size_t level) {
+  assert(level <= static_cast<std::size_t>(std::numeric_limits<int>::max()));
+  return write_labelled_number(out, "Level: ", level);
+}
+
+[[nodiscard]] inline std::string encode_level_line(std::size_t level) {
+  std::string out;
+  encode_level_line_to(std::back_inserter(out), level);
+  return out;
+}
+
+[[nodiscard]] inline LineStatus try_decode_level_line(std::string_view line, std::size_t &out) noexcept {
+  return try_decode_positive_line(line, "Level:", DecodeErrc::LevelTooLow, out);
+}
+
+[[nodiscard]] inline std::size_t decode_level_line(std::string_view line) {
+  std::size_t out = 0;
+  check(try_decode_level_line(line, out));
+  return out;
+}
+
+template <typename OutputIt>
+OutputIt encode_shiny_line_to(OutputIt out, bool shiny) {
+  return write_text(out, shiny ? "Shiny: Yes" : "Shiny: No");
+}
+
+[[nodiscard]] inline std::string encode_shiny_line(bool shiny) {
+  std::string out;
+  encode_shiny_line_to(std::back_inserter(out), shiny);
+  return out;
+}
+
+[[nodiscard]] inline LineStatus try_decode_shiny_line(std::string_view line, bool &out) noexcept {
+  return try_decode_bool_line(line, "Shiny:", out, DecodeErrc::InvalidShiny);
+}
+
+[[nodiscard]] inline bool decode_shiny_line(std::string_view line) {
+  bool out = false;
+  check(try_decode_shiny_line(line, out));
+  return out;
+}
+
+template <typename OutputIt>
+OutputIt encode_happiness_line_to(OutputIt out, std::size_t happiness) {
+  assert(happiness <= static_cast<std::size_t>(std::numeric_limits<int>::max()));
+  return write_labelled_number(out, "Happiness: ", happiness);
+}
+
+[[nodiscard]] inline std::string encode_happiness_line(std::size_t happiness) {
+  std::string out;
+  encode_happiness_line_to(std::back_inserter(out), happiness);
+  return out;
+}
+
+[[nodiscard]] inline LineStatus try_decode_happiness_line(std::string_view line, std::size_t &out) noexcept {
+  return try_decode_positive_line(line, "Happiness:", DecodeErrc::HappinessTooLow, out);
+}
+
+[[nodiscard]] inline std::size_t decode_happiness_line(
+  std::string_view line
+) {
+  std::size_t out = 0;
+  check(try_decode_happiness_line(line, out));
+  return out;
+}
+
+template <typename OutputIt>
+OutputIt encode_dynamax_level_line_to(OutputIt out, std::size_t dynamax_level) {
+  assert(dynamax_level <= static_cast<std::size_t>(std::numeric_limits<int>::max()));
+  return write_labelled_number(out, "Dynamax Level: ", dynamax_level);
+}
+
+[[nodiscard]] inline std::string encode_dynamax_level_line(std::size_t dynamax_level) {
+  std::string out;
+  encode_dynamax_level_line_to(std::back_inserter(out), dynamax_level);
+  return out;
+}
+
+[[nodiscard]] inline LineStatus try_decode_dynamax_level_line(std::string_view line, std::size_t &out) noexcept {
+  return try_decode_positive_line(line, "Dynamax Level:", DecodeErrc::DynamaxLevelTooLow, out);
+}
+
+[[nodiscard]] inline std::size_t decode_dynamax_level_line(
+  std::string_view line
+) {
+  std::size_t out = 0;
+  check(try_decode_dynamax_level_line(line, out));
+  return out;
+}
+
+template <typename OutputIt>
+OutputIt encode_gigantamax_line_to(OutputIt out, bool gmax) {
+  return write_text(out, gmax ? "Gigantamax: Yes" : "Gigantamax: No");
+}
+
+[[nodiscard]] inline std::string encode_gigantamax_line(bool gmax) {
+  std::string out;
+  encode_gigantamax_line_to(std::back_inserter(out), gmax);
+  return out;
+}
+
+[[nodiscard]] inline LineStatus try_decode_gigantamax_line(std::string_view line, bool &out) noexcept {
+  return try_decode_bool_line(line, "Gigantamax:", out, DecodeErrc::InvalidGigantamax);
+}
+
+[[nodiscard]] inline bool decode_gigantamax_line(std::string_view line) {
+  bool out = false;
+  check(try_decode_gigantamax_line(line, out));
+  return out;
+}
+
+template <typename OutputIt>
+OutputIt encode_tera_type_line_to(OutputIt out, std::string_view tera_type) {
+  return write_labelled_line(out, "Tera Type: ", tera_type);
+}
+
+[[nodiscard]] inline std::string encode_tera_type_line(std::string_view tera_type) {
+  std::string out;
+  encode_tera_type_line_to(std::back_inserter(out), tera_type);
+  return out;
+}
+
+[[nodiscard]] inline LineStatus try_decode_tera_type_line_view(std::string_view line, std::string_view &out) noexcept {
+  const auto value = decode_string_line_view(line, "Tera Type:");
+  if (value.empty()) {
+    return LineError{DecodeErrc::EmptyTeraType, line.size()};
+  }
+  out = value;
+  return std::nullopt;
+}
+
+[[nodiscard]] inline std::string_view decode_tera_type_line_view(
+  std::string_view line
+) {
+  std::string_view out;
+  check(try_decode_tera_type_line_view(line, out));
+  return out;
+}
+
+[[nodiscard]] inline std::string decode_tera_type_line(
+  std::string_view line
+) {
+  return std::string{decode_tera_type_line_view(line)};
+}
+
+template <typename OutputIt>
+OutputIt encode_evs_line_to(OutputIt out, const Pokemon::Stats &evs) {
+  return encode_stat_line_to(out, evs, "EVs: ");
+}
+
+[[nodiscard]] inline std::string encode_evs_line(const Pokemon::Stats &evs) {
+  std::string out;
+  encode_evs_line_to(std::back_inserter(out), evs);
+  return out;
+}
+
+[[nodiscard]] inline LineStatus try_decode_evs_line(std::string_view line, Pokemon::Stats &out) noexcept {
+  return try_decode_stat_line(line, "EVs:", {}, out);
+}
+
+[[nodiscard]] inline Pokemon::Stats decode_evs_line(std::string_view line) {
+  return decode_stat_line(line, "EVs:");
+}
+
+template <typename OutputIt>
+OutputIt encode_nature_line_to(OutputIt out, std::string_view nature) {
+  out = write_text(out, nature);
+  return write_text(out, " Nature");
+}
+
+[[nodiscard]] inline std::string encode_nature_line(std::string_view nature) {
+  std::string out;
+  encode_nature_line_to(std::back_inserter(out), nature);
+  return out;
+}
+
+[[nodiscard]] inline LineStatus try_decode_nature_line_view(std::string_view line, std::string_view &out) noexcept {
+  const auto upto  = line.rfind("Nature");
+  const auto value = util::trim_view(line.substr(0, upto));
+  if (value.empty()) {
+    return LineError{DecodeErrc::EmptyNature, 0};
+  }
+  out = value;
+  return std::nullopt;
+}
+
+[[nodiscard]] inline std::string_view decode_nature_line_view(std::string_view line) {
+  std::string_view out;
+  check(try_decode_nature_line_view(line, out));
+  return out;
+}
+
+[[nodiscard]] inline std::string decode_nature_line(std::string_view line) {
+  return std::string{decode_nature_line_view(line)};
+}
+
+template <typename OutputIt>
+OutputIt encode_ivs_line_to(OutputIt out, const Pokemon::Stats &ivs) {
+  return encode_stat_line_to(out, ivs, "IVs: ", Pokemon::DEFAULT_IVS);
+}
+
+[[nodiscard]] inline std::string encode_ivs_line(const Pokemon::Stats &ivs) {
+  std::string out;
+  encode_ivs_line_to(std::back_inserter(out), ivs);
+  return out;
+}
+
+[[nodiscard]] inline LineStatus try_decode_ivs_line(std::string_view line, Pokemon::Stats &out) noexcept {
+  return try_decode_stat_line(line, "IVs:", Pokemon::DEFAULT_IVS, out);
+}
+
+[[nodiscard]] inline Pokemon::Stats decode_ivs_line(std::string_view line) {
+  return decode_stat_line(line, "IVs:", Pokemon::DEFAULT_IVS);
+}
+
+template <typename OutputIt>
+OutputIt encode_move_line_to(OutputIt out, std::string_view move) {
+  return write_labelled_line(out, "- ", move);
+}
+
+[[nodiscard]] inline std::string encode_move_line(std::string_view move) {
+  std::string out;
+  encode_move_line_to(std::back_inserter(out), move);
+  return out;
+}
+
+[[nodiscard]] inline LineStatus try_decode_move_line_view(std::string_view line, std::string_view &out) noexcept {
+  const auto value = decode_string_line_view(line, "-");
+  if (value.empty()) {
+    return LineError{DecodeErrc::EmptyMove, line.size()};
+  }
+  out = value;
+  return std::nullopt;
+}
+
+[[nodiscard]] inline std::string_view decode_move_line_view(std::string_view line) {
+  std::string_view out;
+  check(try_decode_move_line_view(line, out));
+  return out;
+}
+
+[[nodiscard]] inline std::string decode_move_line(std::string_view line) {
+  return std::string{decode_move_line_view(line)};
+}
+
+} // namespace detail
+
+namespace detail {
+
+// Shared by the encoders of every Pokemon representation; PokemonT only needs Pokemon's field names,
+// with text fields convertible to string_view and moves iterable. Lines are separated, not terminated,
+// by newlines
+template <typename OutputIt, typename PokemonT>
+OutputIt encode_pokemon_fields_to(OutputIt out, const PokemonT &pokemon) {
+  out = encode_name_line_to(
+    out,
+    SpeciesLineView{
+      pokemon.nickname,
+      pokemon.species,
+      pokemon.gender,
+      pokemon.item
+    }
+  );
+  *out++ = '\n';
+  out    = encode_ability_line_to(out, pokemon.ability);
+  if (pokemon.level.has_value()) {
+    *out++ = '\n';
+    out    = encode_level_line_to(out, pokemon.level.value());
+  }
+  if (pokemon.shiny) {
+    *out++ = '\n';
+    out    = encode_shiny_line_to(out, pokemon.shiny);
+  }
+  if (pokemon.happiness != Pokemon::DEFAULT_HAPPINESS) {
+    *out++ = '\n';
+    out    = encode_happiness_line_to(out, pokemon.happiness);
+  }
+  if (pokemon.dynamax_level != Pokemon::DEFAULT_DYNAMAX_LEVEL) {
+    *out++ = '\n';
+    out    = encode_dynamax_level_line_to(out, pokemon.dynamax_level);
+  }
+  if (pokemon.gigantamax) {
+    *out++ = '\n';
+    out    = encode_gigantamax_line_to(out, pokemon.gigantamax);
+  }
+  if (pokemon.tera_type.has_value()) {
+    *out++ = '\n';
+    out    = encode_tera_type_line_to(out, pokemon.tera_type.value());
+  }
+  if (pokemon.evs != Pokemon::Stats{0, 0, 0, 0, 0, 0}) {
+    *out++ = '\n';
+    out    = encode_evs_line_to(out, pokemon.evs);
+  }
+  if (pokemon.nature.has_value()) {
+    *out++ = '\n';
+    out    = encode_nature_line_to(out, pokemon.nature.value());
+  }
+  if (pokemon.ivs != Pokemon::DEFAULT_IVS) {
+    *out++ = '\n';
+    out    = encode_ivs_line_to(out, pokemon.ivs);
+  }
+  for (const auto &move : pokemon.moves) {
+    *out++ = '\n';
+    out    = encode_move_line_to(out, move);
+  }
+  return out;
+}
+
+// Trims the whitespace around out[from, end) in place, leaving what comes before from untouched
+inline void trim_from(std::string &out, std::size_t from) {
+  const auto last = out.find_last_not_of(" \t\r\n");
+  if ((last == std::string::npos) || (last < from)) {
+    out.resize(from);
+    return;
+  }
+  out.resize(last + 1);
+  out.erase(from, out.find_first_not_of(" \t\r\n", from) - from);
+}
+
+} // namespace detail
+
+// Writes the same text as encode_pokemon through out, without building any intermediate strings
+template <typename OutputIt>
+OutputIt encode_pokemon_to(OutputIt out, const Pokemon &pokemon) {
+  return detail::encode_pokemon_fields_to(out, pokemon);
+}
+
+// Exact length of encode_pokemon's result, without encoding it
+[[nodiscard]] inline std::size_t encoded_size(const Pokemon &pokemon) {
+  return encode_pokemon_to(detail::SizeCounter{}, pokemon).size();
+}
+
+[[nodiscard]] inline std::string encode_pokemon(const Pokemon &pokemon) {
+  std::string out;
+  out.reserve(encoded_size(pokemon));
+  encode_pokemon_to(std::back_inserter(out), pokemon);
+  return out;
+}
+
+template <typename OutputIt>
+OutputIt encode_pokemon_to(OutputIt out, const pmr::Pokemon &pokemon) {
+  return detail::encode_pokemon_fields_to(out, pokemon);
+}
+
+[[nodiscard]] inline std::size_t encoded_size(const pmr::Pokemon &pokemon) {
+  return encode_pokemon_to(detail::SizeCounter{}, pokemon).size();
+}
+
+[[nodiscard]] inline std::string encode_pokemon(const pmr::Pokemon &pokemon) {
+  std::string out;
+  out.reserve(encoded_size(pokemon));
+  encode_pokemon_to(std::back_inserter(out), pokemon);
+  return out;
+}
+
+namespace detail {
+
+[[nodiscard]] constexpr std::uint16_t field_bit(FieldKind kind) noexcept {
+  return static_cast<std::uint16_t>(1U << util::to_underlying(kind));
+}
+
+// Works out which field a trimmed body line holds from its first byte, so at most one prefix is
+// compared before the Nature suffix. Prefixed fields take precedence over a trailing "Nature", which
+// takes precedence over IVs and moves, matching the order the fields have always been tried in
+[[nodiscard]] constexpr std::optional<FieldKind> classify_line(std::string_view line) noexcept {
+  if (line.empty()) {
+    return std::nullopt;
+  }
+  switch (line.front()) {
+  case 'A':
+    if (util::starts_with(line, "Ability:")) {
+      return FieldKind::Ability;
+    }
+    break;
+  case 'L':
+    if (util::starts_with(line, "Level:")) {
+      return FieldKind::Level;
+    }
+    break;
+  case 'S':
+    if (util::starts_with(line, "Shiny:")) {
+      return FieldKind::Shiny;
+    }
+    break;
+  case 'H':
+    if (util::starts_with(line, "Happiness:")) {
+      return FieldKind::Happiness;
+    }
+    break;
+  case 'D':
+    if (util::starts_with(line, "Dynamax Level:")) {
+      return FieldKind::DynamaxLevel;
+    }
+    break;
+  case 'G':
+    if (util::starts_with(line, "Gigantamax:")) {
+      return FieldKind::Gigantamax;
+    }
+    break;
+  case 'T':
+    if (util::starts_with(line, "Tera Type:")) {
+      return FieldKind::TeraType;
+    }
+    break;
+  case 'E':
+    if (util::starts_with(line, "EVs:")) {
+      return FieldKind::EVs;
+    }
+    break;
+  default:
+    break;
+  }
+  if (util::ends_with(line, "Nature")) {
+    return FieldKind::Nature;
+  }
+  if (util::starts_with(line, "IVs:")) {
+    return FieldKind::IVs;
+  }
+  if (line.front() == '-') {
+    return FieldKind::Move;
+  }
+  return std::nullopt;
+}
+
+// Context for decoding into Pokemon and PokemonView, whose text fields take the decoded views as is
+struct PlainText {};
+
+template <typename String>
+void assign_text(PlainText, String &field, std::string_view value) {
+  if constexpr (std::is_same_v<String, std::string>) {
+    count_growth(field, value.size());
+  }
+  field = value;
+}
+
+inline void assign_text(SymbolTable &symbols, Symbol &field, std::string_view value) {
+  field = symbols.intern(value);
+}
+
+template <typename Context, typename Field>
+void assign_text(Context &context, std::optional<Field> &field, std::optional<std::string_view> value) {
+  if (!value.has_value()) {
+    field.reset();
+    return;
+  }
+  if (!field.has_value()) {
+    field.emplace();
+  }
+  assign_text(context, field.value(), value.value());
+}
+
+// Each returns false if pokemon has no room for another move
+[[nodiscard]] inline bool add_move(PlainText, Pokemon &pokemon, std::string_view move) {
+  count_growth(pokemon.moves, pokemon.moves.size() + 1);
+  count_new_string(move.size());
+  pokemon.moves.emplace_back(move);
+  return true;
+}
+
+[[nodiscard]] inline bool add_move(PlainText, PokemonView &pokemon, std::string_view move) {
+  if (pokemon.move_count == PokemonView::MAX_MOVES) {
+    return false;
+  }
+  pokemon.moves[pokemon.move_count++] = move;
+  return true;
+}
+
+[[nodiscard]] inline bool add_move(PlainText, BorrowedPokemon &pokemon, std::string_view move) {
+  pokemon.moves.push_back(move);
+  return true;
+}
+
+[[nodiscard]] inline bool add_move(SymbolTable &symbols, InternedPokemon &pokemon, std::string_view move) {
+  pokemon.moves.push_back(symbols.intern(move));
+  return true;
+}
+
+// Context for decoding into pmr::Pokemon. Strings it has to create are given resource, the rest
+// already carry the Pokemon's own
+struct PmrText {
+  std::pmr::memory_resource *resource = std::pmr::get_default_resource();
+};
+
+inline void assign_text(PmrText, std::pmr::string &field, std::string_view value) {
+  field.assign(value);
+}
+
+inline void assign_text(PmrText context, std::optional<std::pmr::string> &field, std::optional<std::string_view> value) {
+  if (!value.has_value()) {
+    field.reset();
+  } else if (field.has_value()) {
+    field->assign(value.value());
+  } else {
+    field.emplace(value.value(), context.resource);
+  }
+}
+
+[[nodiscard]] inline bool add_move(PmrText, pmr::Pokemon &pokemon, std::string_view move) {
+  pokemon.moves.emplace_back(move);
+  return true;
+}
+
+// Decodes the next Pokemon from lines, consuming the empty line that ends its block, so a whole paste
+// is decoded in a single pass over its lines. Returns false if the input ran out before any Pokemon,
+// or if the Pokemon is malformed, in which case error says why and lines is left just past the
+// offending line. Never throws for malformed input.
+// Shared by every decoder; the decoded text reaches PokemonT through the assign_text and add_move
+// overloads for Context
+template <typename PokemonT, typename Context = PlainText>
+[[nodiscard]] bool try_decode_pokemon_fields(LineReader &lines, PokemonT &out, std::optional<DecodeError> &error, Context &&context = {}) {
+  std::optional<std::string_view> name_line;
+  std::size_t name_line_number = 0;
+  std::size_t name_indent      = 0;
+  while (const auto line = lines.next()) {
+    const auto trimmed = util::trim_view(line.value());
+    if (!trimmed.empty()) {
+      name_line        = trimmed;
+      name_line_number = lines.line_number();
+      name_indent      = static_cast<std::size_t>(trimmed.data() - line->data());
+      break;
+    }
+  }
+  if (!name_line.has_value()) {
+    return false;
+  }
+  const auto fail = [&](LineError line_error, std::size_t line_number, std::size_t indent, std::optional<FieldKind> field) {
+    error = DecodeError{line_error.code, line_number, indent + line_error.offset + 1, field};
+    return false;
+  };
+
+  count(FieldKind::Name);
+  SpeciesLineView name;
+  LineStatus name_status;
+  {
+    const PhaseTimer timer{DecodePhase::NameLine};
+    name_status = try_decode_name_line_view(name_line.value(), name);
+  }
+  if (name_status.has_value()) {
+    return fail(name_status.value(), name_line_number, name_indent, FieldKind::Name);
+  }
+  assign_text(context, out.nickname, name.nickname);
+  assign_text(context, out.species, name.species);
+  out.gender = name.gender;
+  assign_text(context, out.item, name.item);
+
+  std::uint16_t found        = 0;
+  std::size_t body_lines     = 0;
+  std::size_t pending_blanks = 0;
+  while (const auto raw_line = lines.next()) {
+    if (raw_line->empty()) {
+      break;
+    }
+    const auto line = util::trim_view(raw_line.value());
+    // Whitespace only lines are only tolerated at the end of the block
+    if (line.empty()) {
+      pending_blanks++;
+      continue;
+    }
+    const PhaseTimer timer{DecodePhase::Dispatch};
+    const auto line_number = lines.line_number();
+    const auto indent      = static_cast<std::size_t>(line.data() - raw_line->data());
+    const auto kind        = classify_line(line);
+    if (!kind.has_value()) {
+      count(Counter::UnknownLines);
+    } else {
+      count(kind.value());
+    }
+    if (pending_blanks > 0) {
+      return fail({DecodeErrc::UnknownLine}, line_number, indent, std::nullopt);
+    }
+    body_lines++;
+    if (!kind.has_value()) {
+      return fail({DecodeErrc::UnknownLine}, line_number, indent, std::nullopt);
+    }
+    LineStatus status;
+    std::string_view text;
+    switch (kind.value()) {
+    case FieldKind::Ability:
+      if (status = try_decode_ability_line_view(line, text); !status) {
+        assign_text(context, out.ability, text);
+      }
+      break;
+    case FieldKind::Level: {
+      std::size_t level = 0;
+      if (status = try_decode_level_line(line, level); !status) {
+        out.level = level;
+      }
+      break;
+    }
+    case FieldKind::Shiny:
+      status = try_decode_shiny_line(line, out.shiny);
+      break;
+    case FieldKind::Happiness:
+      status = try_decode_happiness_line(line, out.happiness);
+      break;
+    case FieldKind::DynamaxLevel:
+      status = try_decode_dynamax_level_line(line, out.dynamax_level);
+      break;
+    case FieldKind::Gigantamax:
+      status = try_decode_gigantamax_line(line, out.gigantamax);
+      break;
+    case FieldKind::TeraType:
+      if (status = try_decode_tera_type_line_view(line, text); !status) {
+        assign_text(context, out.tera_type, std::optional{text});
+      }
+      break;
+    case FieldKind::EVs:
+      status = try_decode_evs_line(line, out.evs);
+      break;
+    case FieldKind::Nature:
+      if (status = try_decode_nature_line_view(line, text); !status) {
+        assign_text(context, out.nature, std::optional{text});
+      }
+      break;
+    case FieldKind::IVs:
+      status = try_decode_ivs_line(line, out.ivs);
+      break;
+    case FieldKind::Move:
+      if (status = try_decode_move_line_view(line, text); status) {
+        return fail(status.value(), line_number, indent, kind);
+      }
+      if (!add_move(context, out, text)) {
+        return fail({DecodeErrc::TooManyMoves}, line_number, indent, kind);
+      }
+      // Any number of moves is allowed
+      continue;
+    default:
+      return fail({DecodeErrc::UnknownLine}, line_number, indent, std::nullopt);
+    }
+    if (status.has_value()) {
+      return fail(status.value(), line_number, indent, kind);
+    }
+    const auto bit = field_bit(kind.value());
+    if ((found & bit) != 0) {
+      return fail({DecodeErrc::DuplicateLine}, line_number, indent, kind);
+    }
+    found |= bit;
+  }
+
+  if (body_lines == 0) {
+    return fail({DecodeErrc::NotEnoughLines}, name_line_number, name_indent, std::nullopt);
+  }
+  if ((found & field_bit(FieldKind::Ability)) == 0) {
+    return fail({DecodeErrc::MissingAbility}, name_line_number, name_indent, FieldKind::Ability);
+  }
+  return true;
+}
+
+template <typename PokemonT, typename Context = PlainText>
+[[nodiscard]] bool decode_pokemon_fields(LineReader &lines, PokemonT &out, Context &&context = {}) {
+  std::optional<DecodeError> error;
+  const auto decoded = try_decode_pokemon_fields(lines, out, error, context);
+  if (error.has_value()) {
+    throw_decode_error(error->code);
+  }
+  return decoded;
+}
+
+// A lone Pokemon may only be followed by blank lines, not another block
+template <typename PokemonT, typename Context = PlainText>
+void try_decode_single_pokemon(std::string_view data, PokemonT &out, std::optional<DecodeError> &error, Context &&context = {}) {
+  LineReader lines{data};
+  if (!try_decode_pokemon_fields(lines, out, error, context)) {
+    if (!error.has_value()) {
+      error = DecodeError{DecodeErrc::NotEnoughLines, std::max(lines.line_number(), std::size_t{1}), 1, std::nullopt};
+    }
+    return;
+  }
+  while (const auto line = lines.next()) {
+    const auto trimmed = util::trim_view(line.value());
+    if (!trimmed.empty()) {
+      error = DecodeError{DecodeErrc::UnknownLine, lines.line_number(), static_cast<std::size_t>(trimmed.data() - line->data()) + 1, std::nullopt};
+      return;
+    }
+  }
+}
+
+template <typename PokemonT, typename Context = PlainText>
+void decode_single_pokemon(std::string_view data, PokemonT &out, Context &&context = {}) {
+  std::optional<DecodeError> error;
+  try_decode_single_pokemon(data, out, error, context);
+  if (error.has_value()) {
+    throw_decode_error(error->code);
+  }
+}
+
+// Stops at the first malformed Pokemon, returning those decoded before it
+template <typename PokemonT, typename Context = PlainText>
+[[nodiscard]] std::vector<PokemonT> try_decode_all_pokemon(std::string_view paste, std::optional<DecodeError> &error, Context &&context = {}) {
+  std::vector<PokemonT> out;
+  LineReader lines{paste};
+  PokemonT pokemon;
+  while (try_decode_pokemon_fields(lines, pokemon, error, context)) {
+    count_growth(out, out.size() + 1);
+    out.push_back(std::move(pokemon));
+    pokemon = PokemonT{};
+  }
+  return out;
+}
+
+// Decodes every block independently, collecting the malformed ones in errors instead of stopping.
+// A block is abandoned at its first bad line, skipping the rest of it so the next one starts cleanly
+template <typename PokemonT, typename Context = PlainText>
+[[nodiscard]] std::vector<PokemonT> recover_all_pokemon(std::string_view paste, std::vector<BlockDecodeError> &errors, Context &&context = {}) {
+  std::vector<PokemonT> out;
+  LineReader lines{paste};
+  PokemonT pokemon;
+  std::optional<DecodeError> error;
+  for (std::size_t block = 0;; block++) {
+    if (try_decode_pokemon_fields(lines, pokemon, error, context)) {
+      out.push_back(std::move(pokemon));
+    } else if (error.has_value()) {
+      // Errors found once the whole block was read are reported against its earlier name line
+      if (error->line == lines.line_number()) {
+        lines.skip_block();
+      }
+      errors.push_back({block, error.value()});
+      error.reset();
+    } else {
+      return out;
+    }
+    pokemon = PokemonT{};
+  }
+}
+
+template <typename PokemonT, typename Context = PlainText>
+[[nodiscard]] std::vector<PokemonT> decode_all_pokemon(std::string_view paste, Context &&context = {}) {
+  std::optional<DecodeError> error;
+  auto out = try_decode_all_pokemon<PokemonT>(paste, error, context);
+  if (error.has_value()) {
+    throw_decode_error(error->code);
+  }
+  return out;
+}
+
+} // namespace detail
+
+// Reports malformed input through the result rather than by throwing
+[[nodiscard]] inline TryDecodeResult<Pokemon> try_decode_pokemon(std::string_view data) {
+  TryDecodeResult<Pokemon> result;
+  detail::try_decode_single_pokemon(data, result.value, result.error);
+  if (result.error.has_value()) {
+    result.value = Pokemon{};
+  }
+  return result;
+}
+
+[[nodiscard]] inline Pokemon decode_pokemon(std::string_view data) {
+  auto result = try_decode_pokemon(data);
+  if (!result.ok()) {
+    detail::throw_decode_error(result.error->code);
+  }
+  return std::move(result.value);
+}
+
+namespace detail {
+
+// Restores every field a decode only writes when its line is present, keeping the storage of each
+// string and of the move list for the decode to assign into
+inline void reset_for_decode(Pokemon &pokemon) noexcept {
+  pokemon.level.reset();
+  pokemon.shiny         = false;
+  pokemon.happiness     = Pokemon::DEFAULT_HAPPINESS;
+  pokemon.dynamax_level = Pokemon::DEFAULT_DYNAMAX_LEVEL;
+  pokemon.gigantamax    = false;
+  pokemon.evs           = Pokemon::Stats{};
+  pokemon.ivs           = Pokemon::DEFAULT_IVS;
+  if (pokemon.tera_type.has_value()) {
+    pokemon.tera_type->clear();
+  }
+  if (pokemon.nature.has_value()) {
+    pokemon.nature->clear();
+  }
+  pokemon.moves.clear();
+}
+
+// Decoded values are never empty, so a field reset_for_decode emptied that is still empty had no line
+inline void drop_unset_text(Pokemon &pokemon) noexcept {
+  if (pokemon.tera_type.has_value() && pokemon.tera_type->empty()) {
+    pokemon.tera_type.reset();
+  }
+  if (pokemon.nature.has_value() && pokemon.nature->empty()) {
+    pokemon.nature.reset();
+  }
+}
+
+} // namespace detail
+
+// Decodes data into out, assigning into its existing strings and move list rather than building new
+// ones, so decoding into the same Pokemon over and over stops allocating once it has held the longest
+// text of each field. Throws like decode_pokemon, leaving out valid but unspecified
+inline void decode_pokemon_into(std::string_view data, Pokemon &out) {
+  detail::reset_for_decode(out);
+  detail::decode_single_pokemon(data, out);
+  detail::drop_unset_text(out);
+}
+
+[[nodiscard]] inline PokemonView decode_pokemon_view(std::string_view data) {
+  PokemonView out;
+  detail::decode_single_pokemon(data, out);
+  return out;
+}
+
+namespace detail {
+
+// Pokemon are trimmed and separated by an empty line, so one that encodes to only whitespace leaves
+// an extra empty line unless it comes first or last
+template <typename PasteT>
+void encode_pokepaste_fields_to(std::string &out, const PasteT &paste) {
+  const auto begin = out.size();
+  bool wrote_text  = false;
+  for (const auto &pokemon : paste) {
+    // Separators are only written once there is text before them, and the final trim drops any
+    // after the last Pokemon, so out never grows past the encoded size of well formed pastes
+    if (wrote_text) {
+      out.append("\n\n");
+    }
+    const auto pokemon_begin = out.size();
+    encode_pokemon_to(std::back_inserter(out), pokemon);
+    trim_from(out, pokemon_begin);
+    wrote_text = wrote_text || (out.size() > pokemon_begin);
+  }
+  trim_from(out, begin);
+}
+
+template <typename PasteT>
+[[nodiscard]] std::size_t encoded_paste_size(const PasteT &paste) {
+  std::size_t size = 0;
+  std::optional<std::size_t> first_text, last_text;
+  for (std::size_t i = 0; i < paste.size(); i++) {
+    const auto pokemon_size = encode_pokemon_to(SizeCounter{}, paste[i]).trimmed_size();
+    if (pokemon_size > 0) {
+      size += pokemon_size;
+      first_text = first_text.value_or(i);
+      last_text  = i;
+    }
+  }
+  if (!first_text.has_value()) {
+    return 0;
+  }
+  return size + (2 * (last_text.value() - first_text.value()));
+}
+
+} // namespace detail
+
+// Appends the same text as encode_pokepaste to out, so one buffer can be reused across pastes
+inline void encode_pokepaste_to(std::string &out, const PokePaste &paste) {
+  detail::encode_pokepaste_fields_to(out, paste);
+}
+
+// Exact length of encode_pokepaste's result. encode_pokepaste_to doesn't reserve by itself, so that
+// appending many pastes to one buffer keeps growing it geometrically; reserve with this to avoid that
+[[nodiscard]] inline std::size_t encoded_size(const PokePaste &paste) {
+  return detail::encoded_paste_size(paste);
+}
+
+[[nodiscard]] inline std::string encode_pokepaste(const PokePaste &paste) {
+  std::string out;
+  out.reserve(encoded_size(paste));
+  encode_pokepaste_to(out, paste);
+  return out;
+}
+
+inline void encode_pokepaste_to(std::string &out, const pmr::PokePaste &paste) {
+  detail::encode_pokepaste_fields_to(out, paste);
+}
+
+[[nodiscard]] inline std::size_t encoded_size(const pmr::PokePaste &paste) {
+  return detail::encoded_paste_size(paste);
+}
+
+[[nodiscard]] inline std::string encode_pokepaste(const pmr::PokePaste &paste) {
+  std::string out;
+  out.reserve(encoded_size(paste));
+  encode_pokepaste_to(out, paste);
+  return out;
+}
+
+// Reports malformed input through the result rather than by throwing, so invalid pastes cost no
+// more to reject than valid ones cost to decode
+[[nodiscard]] inline TryDecodeResult<PokePaste> try_decode_pokepaste(std::string_view paste) {
+  TryDecodeResult<PokePaste> result;
+  result.value = detail::try_decode_all_pokemon<Pokemon>(paste, result.error);
+  if (result.error.has_value()) {
+    result.value.clear();
+  }
+  return result;
+}
+
+struct RecoveredPokePaste {
+  // Every Pokemon that decoded, in paste order
+  PokePaste pokemon;
+  // One entry per malformed block, in paste order
+  std::vector<BlockDecodeError> errors;
+
+  [[nodiscard]] bool ok() const noexcept {
+    return errors.empty();
+  }
+};
+
+// Salvages what it can from a partially corrupt paste: each blank line separated block is decoded on
+// its own, so one malformed Pokemon only loses that Pokemon. Never throws for malformed input
+[[nodiscard]] inline RecoveredPokePaste decode_pokepaste_recovering(std::string_view paste) {
+  RecoveredPokePaste result;
+  result.pokemon = detail::recover_all_pokemon<Pokemon>(paste, result.errors);
+  return result;
+}
+
+[[nodiscard]] inline PokePaste decode_pokepaste(std::string_view paste) {
+  auto result = try_decode_pokepaste(paste);
+  if (!result.ok()) {
+    detail::throw_decode_error(result.error->code);
+  }
+  return std::move(result.value);
+}
+
+// Decodes paste into out, reusing the Pokemon it already holds and their storage, so a paste of the
+// same size decoded into it stops allocating once warmed up. Pokemon beyond the new count are
+// destroyed. Throws like decode_pokepaste, leaving out valid but unspecified
+inline void decode_pokepaste_into(std::string_view paste, PokePaste &out) {
+  detail::LineReader lines{paste};
+  std::size_t count = 0;
+  while (true) {
+    if (count == out.size()) {
+      detail::count_growth(out, count + 1);
+      out.emplace_back();
+    }
+    auto &pokemon = out[count];
+    detail::reset_for_decode(pokemon);
+    if (!detail::decode_pokemon_fields(lines, pokemon)) {
+      break;
+    }
+    detail::drop_unset_text(pokemon);
+    count++;
+  }
+  out.erase(out.begin() + static_cast<std::ptrdiff_t>(count), out.end());
+}
+
+// Every string and move list of the result is allocated from resource
+[[nodiscard]] inline pmr::Pokemon decode_pokemon(std::string_view data, std::pmr::memory_resource *resource) {
+  pmr::Pokemon out{resource};
+  std::optional<DecodeError> error;
+  detail::try_decode_single_pokemon(data, out, error, detail::PmrText{resource});
+  if (error.has_value()) {
+    detail::throw_decode_error(error->code);
+  }
+  return out;
+}
+
+// Allocates the result and everything in it from resource, so with a monotonic_buffer_resource the
+// whole paste is released at once with the arena
+[[nodiscard]] inline pmr::PokePaste decode_pokepaste(std::string_view paste, std::pmr::memory_resource *resource) {
+  pmr::PokePaste out{resource};
+  detail::LineReader lines{paste};
+  std::optional<DecodeError> error;
+  // Each Pokemon is decoded in place, so it is built with the paste's resource rather than copied into it
+  while (detail::try_decode_pokemon_fields(lines, out.emplace_back(), error, detail::PmrText{resource})) {
+  }
+  out.pop_back();
+  if (error.has_value()) {
+    detail::throw_decode_error(error->code);
+  }
+  return out;
+}
+
+// The returned views refer into paste, which must outlive them
+[[nodiscard]] inline PokePasteView decode_pokepaste_view(std::string_view paste) {
+  return detail::decode_all_pokemon<PokemonView>(paste);
+}
+
+// Throws domain_bound_error if the Pokemon doesn't fit a CompactPokemon
+[[nodiscard]] inline CompactPokemon decode_pokemon_compact(std::string_view data) {
+  detail::BorrowedPokemon pokemon;
+  detail::decode_single_pokemon(data, pokemon);
+  return CompactPokemon{pokemon};
+}
+
+// Each Pokemon is packed straight from views into paste, without building an owning Pokemon first
+[[nodiscard]] inline CompactPokePaste decode_pokepaste_compact(std::string_view paste) {
+  CompactPokePaste out;
+  detail::LineReader lines{paste};
+  detail::BorrowedPokemon pokemon;
+  while (detail::decode_pokemon_fields(lines, pokemon)) {
+    out.emplace_back(pokemon);
+    // Reuse the move list's storage for the next Pokemon
+    auto moves = std::move(pokemon.moves);
+    moves.clear();
+    pokemon       = detail::BorrowedPokemon{};
+    pokemon.moves = std::move(moves);
+  }
+  return out;
+}
+
+template <typename OutputIt>
+OutputIt encode_pokemon_to(OutputIt out, const CompactPokemon &pokemon) {
+  return detail::encode_pokemon_fields_to(out, pokemon.borrow());
+}
+
+[[nodiscard]] inline std::size_t encoded_size(const CompactPokemon &pokemon) {
+  return encode_pokemon_to(detail::SizeCounter{}, pokemon).size();
+}
+
+[[nodiscard]] inline std::string encode_pokemon(const CompactPokemon &pokemon) {
+  std::string out;
+  out.reserve(encoded_size(pokemon));
+  encode_pokemon_to(std::back_inserter(out), pokemon);
+  return out;
+}
+
+inline void encode_pokepaste_to(std::string &out, const CompactPokePaste &paste) {
+  detail::encode_pokepaste_fields_to(out, paste);
+}
+
+[[nodiscard]] inline std::size_t encoded_size(const CompactPokePaste &paste) {
+  return detail::encoded_paste_size(paste);
+}
+
+[[nodiscard]] inline std::string encode_pokepaste(const CompactPokePaste &paste) {
+  std::string out;
+  out.reserve(encoded_size(paste));
+  encode_pokepaste_to(out, paste);
+  return out;
+}
+
+[[nodiscard]] inline CompactPokePaste to_compact(const PokePaste &paste) {
+  CompactPokePaste out;
+  out.reserve(paste.size());
+  for (const auto &pokemon : paste) {
+    out.emplace_back(pokemon);
+  }
+  return out;
+}
+
+[[nodiscard]] inline PokePaste to_owned(const CompactPokePaste &paste) {
+  PokePaste out;
+  out.reserve(paste.size());
+  for (const auto &pokemon : paste) {
+    out.push_back(pokemon.to_owned());
+  }
+  return out;
+}
+
+[[nodiscard]] inline InternedPokemon decode_pokemon_interned(std::string_view data, SymbolTable &symbols) {
+  InternedPokemon out;
+  detail::decode_single_pokemon(data, out, symbols);
+  return out;
+}
+
+// Names are added to symbols as they are decoded, so they are shared with every other paste decoded
+// into the same table
+[[nodiscard]] inline InternedPokePaste decode_pokepaste_interned(std::string_view paste, SymbolTable &symbols) {
+  return detail::decode_all_pokemon<InternedPokemon>(paste, symbols);
+}
+
+[[nodiscard]] inline InternedPokemon intern(const Pokemon &pokemon, SymbolTable &symbols) {
+  InternedPokemon out;
+  detail::assign_text(symbols, out.nickname, pokemon.nickname);
+  out.species = symbols.intern(pokemon.species);
+  out.gender  = pokemon.gender;
+  detail::assign_text(symbols, out.item, pokemon.item);
+  out.ability       = symbols.intern(pokemon.ability);
+  out.level         = pokemon.level;
+  out.shiny         = pokemon.shiny;
+  out.happiness     = pokemon.happiness;
+  out.dynamax_level = pokemon.dynamax_level;
+  out.gigantamax    = pokemon.gigantamax;
+  detail::assign_text(symbols, out.tera_type, pokemon.tera_type);
+  out.evs = pokemon.evs;
+  detail::assign_text(symbols, out.nature, pokemon.nature);
+  out.ivs = pokemon.ivs;
+  out.moves.reserve(pokemon.moves.size());
+  for (const auto &move : pokemon.moves) {
+    out.moves.push_back(symbols.intern(move));
+  }
+  return out;
+}
+
+[[nodiscard]] inline Pokemon to_owned(const InternedPokemon &pokemon, const SymbolTable &symbols) {
+  const auto text = [&](std::optional<Symbol> symbol) -> std::optional<std::string> {
+    if (!symbol.has_value()) {
+      return std::nullopt;
+    }
+    return std::string{symbols.text(symbol.value())};
+  };
+  Pokemon out;
+  out.nickname      = text(pokemon.nickname);
+  out.species       = symbols.text(pokemon.species);
+  out.gender        = pokemon.gender;
+  out.item          = text(pokemon.item);
+  out.ability       = symbols.text(pokemon.ability);
+  out.level         = pokemon.level;
+  out.shiny         = pokemon.shiny;
+  out.happiness     = pokemon.happiness;
+  out.dynamax_level = pokemon.dynamax_level;
+  out.gigantamax    = pokemon.gigantamax;
+  out.tera_type     = text(pokemon.tera_type);
+  out.evs           = pokemon.evs;
+  out.nature        = text(pokemon.nature);
+  out.ivs           = pokemon.ivs;
+  out.moves.reserve(pokemon.moves.size());
+  for (const auto move : pokemon.moves) {
+    out.moves.emplace_back(symbols.text(move));
+  }
+  return out;
+}
+
+[[nodiscard]] inline PokePaste to_owned(const InternedPokePaste &paste, const SymbolTable &symbols) {
+  PokePaste out;
+  out.reserve(paste.size());
+  for (const auto &pokemon : paste) {
+    out.push_back(to_owned(pokemon, symbols));
+  }
+  return out;
+}
+
+// Version encode_binary writes. decode_binary reads every version up to it
+constexpr std::uint8_t BINARY_FORMAT_VERSION = 1;
+
+namespace detail {
+
+// A binary paste is the magic, the version and the number of Pokemon, then each Pokemon as flags
+// followed by the fields they mark present. Integers are LEB128 varints and strings are prefixed by
+// their length
+constexpr std::string_view BINARY_MAGIC = "NGLP";
+
+constexpr std::uint64_t BINARY_NICKNAME      = 1U << 0U;
+constexpr std::uint64_t BINARY_GENDER        = 1U << 1U;
+constexpr std::uint64_t BINARY_FEMALE        = 1U << 2U;
+constexpr std::uint64_t BINARY_ITEM          = 1U << 3U;
+constexpr std::uint64_t BINARY_LEVEL         = 1U << 4U;
+constexpr std::uint64_t BINARY_SHINY         = 1U << 5U;
+constexpr std::uint64_t BINARY_HAPPINESS     = 1U << 6U;
+constexpr std::uint64_t BINARY_DYNAMAX_LEVEL = 1U << 7U;
+constexpr std::uint64_t BINARY_GIGANTAMAX    = 1U << 8U;
+constexpr std::uint64_t BINARY_TERA_TYPE     = 1U << 9U;
+constexpr std::uint64_t BINARY_EVS           = 1U << 10U;
+constexpr std::uint64_t BINARY_NATURE        = 1U << 11U;
+constexpr std::uint64_t BINARY_IVS           = 1U << 12U;
+constexpr std::uint64_t BINARY_FLAGS         = (1U << 13U) - 1U;
+
+inline void write_varint(std::string &out, std::uint64_t value) {
+  while (value >= 0x80U) {
+    out.push_back(static_cast<char>((value & 0x7FU) | 0x80U));
+    value >>= 7U;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+inline void write_binary_text(std::string &out, std::string_view text) {
+  write_varint(out, text.size());
+  out.append(text);
+}
+
+inline void write_binary_stats(std::string &out, const Pokemon::Stats &stats) {
+  for (const auto stat : {stats.hp, stats.atk, stats.def, stats.spatk, stats.spdef, stats.spd}) {
+    write_varint(out, stat);
+  }
+}
+
+inline void write_binary_pokemon(std::string &out, const Pokemon &pokemon) {
+  std::uint64_t flags = 0;
+  flags |= pokemon.nickname.has_value() ? BINARY_NICKNAME : 0;
+  flags |= pokemon.gender.has_value() ? BINARY_GENDER : 0;
+  flags |= (pokemon.gender == Gender::F) ? BINARY_FEMALE : 0;
+  flags |= pokemon.item.has_value() ? BINARY_ITEM : 0;
+  flags |= pokemon.level.has_value() ? BINARY_LEVEL : 0;
+  flags |= pokemon.shiny ? BINARY_SHINY : 0;
+  flags |= (pokemon.happiness != Pokemon::DEFAULT_HAPPINESS) ? BINARY_HAPPINESS : 0;
+  flags |= (pokemon.dynamax_level != Pokemon::DEFAULT_DYNAMAX_LEVEL) ? BINARY_DYNAMAX_LEVEL : 0;
+  flags |= pokemon.gigantamax ? BINARY_GIGANTAMAX : 0;
+  flags |= pokemon.tera_type.has_value() ? BINARY_TERA_TYPE : 0;
+  flags |= (pokemon.evs != Pokemon::Stats{}) ? BINARY_EVS : 0;
+  flags |= pokemon.nature.has_value() ? BINARY_NATURE : 0;
+  flags |= (pokemon.ivs != Pokemon::DEFAULT_IVS) ? BINARY_IVS : 0;
+  write_varint(out, flags);
+
+  if (pokemon.nickname.has_value()) {
+    write_binary_text(out, pokemon.nickname.value());
+  }
+  write_binary_text(out, pokemon.species);
+  if (pokemon.item.has_value()) {
+    write_binary_text(out, pokemon.item.value());
+  }
+  write_binary_text(out, pokemon.ability);
+  if (pokemon.level.has_value()) {
+    write_varint(out, pokemon.level.value());
+  }
+  if ((flags & BINARY_HAPPINESS) != 0) {
+    write_varint(out, pokemon.happiness);
+  }
+  if ((flags & BINARY_DYNAMAX_LEVEL) != 0) {
+    write_varint(out, pokemon.dynamax_level);
+  }
+  if (pokemon.tera_type.has_value()) {
+    write_binary_text(out, pokemon.tera_type.value());
+  }
+  if ((flags & BINARY_EVS) != 0) {
+    write_binary_stats(out, pokemon.evs);
+  }
+  if (pokemon.nature.has_value()) {
+    write_binary_text(out, pokemon.nature.value());
+  }
+  if ((flags & BINARY_IVS) != 0) {
+    write_binary_stats(out, pokemon.ivs);
+  }
+  write_varint(out, pokemon.moves.size());
+  for (const auto &move : pokemon.moves) {
+    write_binary_text(out, move);
+  }
+}
+
+inline void write_binary_header(std::string &out, std::size_t count) {
+  out.append(BINARY_MAGIC);
+  out.push_back(static_cast<char>(BINARY_FORMAT_VERSION));
+  write_varint(out, count);
+}
+
+// Kept out of line of the reader so its hot paths stay small
+[[noreturn]] inline void throw_binary_error(const char *what) {
+  throw std::runtime_error{what};
+}
+
+class BinaryReader {
+public:
+  explicit BinaryReader(std::string_view data) noexcept : data_{data} {}
+
+  [[nodiscard]] std::uint64_t number() {
+    // Nearly every number is a length or stat below 128
+    if ((pos_ < data_.size()) && (static_cast<std::uint8_t>(data_[pos_]) < 0x80U)) {
+      return static_cast<std::uint8_t>(data_[pos_++]);
+    }
+    std::uint64_t out = 0;
+    for (unsigned shift = 0;; shift += 7) {
+      if (pos_ == data_.size()) {
+        throw_binary_error("Binary PokePaste is truncated");
+      }
+      const auto byte = static_cast<std::uint8_t>(data_[pos_++]);
+      // The tenth byte only has room for the top bit
+      if ((shift == 63) && (byte > 1)) {
+        throw_binary_error("Binary PokePaste varint is out of range");
+      }
+      out |= std::uint64_t{byte & 0x7FU} << shift;
+      if ((byte & 0x80U) == 0) {
+        return out;
+      }
+    }
+  }
+
+  // A count of items that take at least a byte each, so a corrupt one can't make decoding reserve
+  // more than the data could hold
+  [[nodiscard]] std::size_t count() {
+    const auto out = number();
+    if (out > remaining()) {
+      throw_binary_error("Binary PokePaste is truncated");
+    }
+    return static_cast<std::size_t>(out);
+  }
+
+  [[nodiscard]] std::string_view bytes(std::size_t size) {
+    if (size > remaining()) {
+      throw_binary_error("Binary PokePaste is truncated");
+    }
+    const auto out = std::string_view{data_.data() + pos_, size};
+    pos_ += size;
+    return out;
+  }
+
+  [[nodiscard]] std::string_view text() {
+    return bytes(count());
+  }
+
+  // Text the text form rejects when empty, like a species or move
+  [[nodiscard]] std::string_view required_text() {
+    const auto out = text();
+    if (out.empty()) {
+      throw_binary_error("Binary PokePaste has an empty field");
+    }
+    return out;
+  }
+
+  // Levels, happiness and Dynamax levels, which the text form reads as ints of at least 1
+  [[nodiscard]] std::size_t positive() {
+    const auto out = number();
+    if ((out == 0) || (out > static_cast<std::uint64_t>(std::numeric_limits<int>::max()))) {
+      throw_binary_error("Binary PokePaste has a value out of range");
+    }
+    return static_cast<std::size_t>(out);
+  }
+
+  [[nodiscard]] Pokemon::Stats stats() {
+    Pokemon::Stats out;
+    for (auto *const stat : {&out.hp, &out.atk, &out.def, &out.spatk, &out.spdef, &out.spd}) {
+      *stat = number();
+    }
+    return out;
+  }
+
+  // Assigns into the string field already holds, if any, to keep its storage
+  void optional_text(bool present, std::optional<std::string> &field, bool required) {
+    if (!present) {
+      field.reset();
+      return;
+    }
+    if (!field.has_value()) {
+      field.emplace();
+    }
+    field->assign(required ? required_text() : text());
+  }
+
+  // Reads everything up to the first Pokemon and returns how many there are
+  [[nodiscard]] std::size_t header() {
+    if (bytes(BINARY_MAGIC.size()) != BINARY_MAGIC) {
+      throw_binary_error("Data is not a binary PokePaste");
+    }
+    const auto version = static_cast<std::uint8_t>(bytes(1).front());
+    if ((version == 0) || (version > BINARY_FORMAT_VERSION)) {
+      throw std::runtime_error{"Binary PokePaste version " + std::to_string(version) + " is not supported"};
+    }
+    // Every Pokemon takes at least a byte for each of its flags, species, ability and move count
+    const auto pokemon = number();
+    if (pokemon > (remaining() / 4)) {
+      throw_binary_error("Binary PokePaste is truncated");
+    }
+    return static_cast<std::size_t>(pokemon);
+  }
+
+  // Overwrites every field of out, so it may be reused from an earlier decode. Rejects what the text
+  // decoders would, so corrupt data can't produce a Pokemon no paste could
+  void pokemon(Pokemon &out) {
+    const auto flags = number();
+    if ((flags & ~BINARY_FLAGS) != 0) {
+      throw_binary_error("Binary PokePaste has unknown flags");
+    }
+    const auto has = [flags](std::uint64_t flag) {
+      return (flags & flag) != 0;
+    };
+    if (has(BINARY_FEMALE) && !has(BINARY_GENDER)) {
+      throw_binary_error("Binary PokePaste has a female flag without a gender");
+    }
+    optional_text(has(BINARY_NICKNAME), out.nickname, false);
+    out.species = required_text();
+    out.gender  = has(BINARY_GENDER) ? std::optional{has(BINARY_FEMALE) ? Gender::F : Gender::M} : std::nullopt;
+    optional_text(has(BINARY_ITEM), out.item, false);
+    out.ability       = required_text();
+    out.level         = has(BINARY_LEVEL) ? std::optional<std::size_t>{positive()} : std::nullopt;
+    out.shiny         = has(BINARY_SHINY);
+    out.happiness     = has(BINARY_HAPPINESS) ? positive() : Pokemon::DEFAULT_HAPPINESS;
+    out.dynamax_level = has(BINARY_DYNAMAX_LEVEL) ? positive() : Pokemon::DEFAULT_DYNAMAX_LEVEL;
+    out.gigantamax    = has(BINARY_GIGANTAMAX);
+    optional_text(has(BINARY_TERA_TYPE), out.tera_type, true);
+    out.evs = has(BINARY_EVS) ? stats() : Pokemon::Stats{};
+    optional_text(has(BINARY_NATURE), out.nature, true);
+    out.ivs = has(BINARY_IVS) ? stats() : Pokemon::DEFAULT_IVS;
+
+    const auto moves = count();
+    out.moves.clear();
+    out.moves.reserve(moves);
+    for (std::size_t i = 0; i < moves; i++) {
+      out.moves.emplace_back(required_text());
+    }
+  }
+
+  [[nodiscard]] std::size_t remaining() const noexcept {
+    return data_.size() - pos_;
+  }
+
+private:
+  std::string_view data_;
+  std::size_t pos_ = 0;
+};
+
+} // namespace detail
+
+// Appends the binary form of paste to out. Every field is kept, so decode_binary returns exactly paste
+inline void encode_binary_to(std::string &out, const PokePaste &paste) {
+  detail::write_binary_header(out, paste.size());
+  for (const auto &pokemon : paste) {
+    detail::write_binary_pokemon(out, pokemon);
+  }
 }
 
-[[nodiscard]] inline std::string encode_happiness_line(std::size_t happiness) {
-  assert(happiness <= static_cast<std::size_t>(std::numeric_limits<int>::max()));
-  return encode_number_line(static_cast<int>(happiness), "Happiness:");
+// Compact, versioned binary form of paste, for storing and sending teams without parsing text again.
+// The bytes are held in a string, but are not text
+[[nodiscard]] inline std::string encode_binary(const PokePaste &paste) {
+  std::string out;
+  encode_binary_to(out, paste);
+  return out;
 }
 
-[[nodiscard]] inline std::size_t decode_happiness_line(
-  const std::string &line
-) {
-  const auto value = decode_number_line(line, "Happiness:");
-  if (value < 1) {
-    throw std::runtime_error{"Pokemon Happiness cannot be less than 0"};
+// A binary paste of just pokemon
+[[nodiscard]] inline std::string encode_binary(const Pokemon &pokemon) {
+  std::string out;
+  detail::write_binary_header(out, 1);
+  detail::write_binary_pokemon(out, pokemon);
+  return out;
+}
+
+// Decodes data into out, assigning into the Pokemon it already holds like decode_pokepaste_into.
+// Throws like decode_binary, leaving out valid but unspecified
+inline void decode_binary_into(std::string_view data, PokePaste &out) {
+  detail::BinaryReader reader{data};
+  const auto count = reader.header();
+  out.resize(count);
+  for (auto &pokemon : out) {
+    reader.pokemon(pokemon);
+  }
+  if (reader.remaining() != 0) {
+    detail::throw_binary_error("Binary PokePaste has trailing data");
   }
-  return static_cast<std::size_t>(value);
 }
 
-[[nodiscard]] inline std::string encode_dynamax_level_line(std::size_t dynamax_level) {
-  assert(dynamax_level <= static_cast<std::size_t>(std::numeric_limits<int>::max()));
-  return encode_number_line(static_cast<int>(dynamax_level), "Dynamax Level:");
+// Throws std::runtime_error if data is not a whole binary paste of a version this library reads, or
+// holds a Pokemon the text decoders would reject, such as one with an empty species or a level of 0
+[[nodiscard]] inline PokePaste decode_binary(std::string_view data) {
+  PokePaste out;
+  decode_binary_into(data, out);
+  return out;
 }
 
-[[nodiscard]] inline std::size_t decode_dynamax_level_line(
-  const std::string &line
-) {
-  const auto value = decode_number_line(line, "Dynamax Level:");
-  if (value < 1) {
-    throw std::runtime_error{"Pokemon Dynamax Level cannot be less than 0"};
+// Decodes a binary paste that holds exactly one Pokemon, like encode_binary(Pokemon) writes
+[[nodiscard]] inline Pokemon decode_binary_pokemon(std::string_view data) {
+  detail::BinaryReader reader{data};
+  if (reader.header() != 1) {
+    detail::throw_binary_error("Binary PokePaste must hold exactly one Pokemon");
+  }
+  Pokemon out;
+  reader.pokemon(out);
+  if (reader.remaining() != 0) {
+    detail::throw_binary_error("Binary PokePaste has trailing data");
   }
-  return static_cast<std::size_t>(value);
+  return out;
 }
 
-[[nodiscard]] inline std::string encode_gigantamax_line(bool gmax) {
-  return encode_bool_line(gmax, "Gigantamax:");
-}
+// Push decoder for pastes that arrive in arbitrary pieces, eg. from a socket. Each Pokemon is passed
+// to the callback as soon as the empty line ending its block is fed, so at most one block and the
+// trailing partial line are buffered at a time
+class PokePasteStreamDecoder {
+public:
+  using Callback = std::function<void(Pokemon)>;
+
+  explicit PokePasteStreamDecoder(Callback on_pokemon) : on_pokemon_{std::move(on_pokemon)} {}
+
+  void feed(std::string_view chunk) {
+    while (!chunk.empty()) {
+      const auto newline = chunk.find('\n');
+      if (newline == std::string_view::npos) {
+        buffer_.append(chunk);
+        return;
+      }
+      buffer_.append(chunk.substr(0, newline + 1));
+      chunk.remove_prefix(newline + 1);
+
+      // A CR ending the previous chunk is still in the buffer, so CRLFs split across chunks are
+      // recognised here too
+      auto line = std::string_view{buffer_}.substr(line_begin_);
+      line.remove_suffix(1);
+      if (!line.empty() && (line.back() == '\r')) {
+        line.remove_suffix(1);
+      }
+      if (line.empty()) {
+        emit_block(line_begin_);
+      } else {
+        line_begin_ = buffer_.size();
+      }
+    }
+  }
+
+  // Decodes whatever is left once the input is exhausted, as the final block needs no terminator
+  void finish() {
+    emit_block(buffer_.size());
+  }
+
+private:
+  void emit_block(std::size_t end) {
+    const auto block = std::string_view{buffer_}.substr(0, end);
+    std::optional<Pokemon> pokemon;
+    try {
+      if (!util::trim_view(block).empty()) {
+        pokemon = decode_pokemon(block);
+      }
+    } catch (...) {
+      reset();
+      throw;
+    }
+    reset();
+    if (pokemon.has_value()) {
+      on_pokemon_(std::move(pokemon.value()));
+    }
+  }
+
+  void reset() noexcept {
+    buffer_.clear();
+    line_begin_ = 0;
+  }
+
+  Callback on_pokemon_;
+  std::string buffer_;
+  std::size_t line_begin_ = 0;
+};
+
+namespace detail {
+
+// Fields of a packed Pokemon, which are separated by '|', in order. The last also holds the extras
+// that follow Happiness, separated by ','
+enum class PackedField : std::uint8_t {
+  Name,
+  Species,
+  Item,
+  Ability,
+  Moves,
+  Nature,
+  EVs,
+  Gender,
+  IVs,
+  Shiny,
+  Level,
+  Misc
+};
+
+constexpr std::size_t PACKED_FIELDS = 12;
+
+// Extras after Happiness, separated by ','. Hidden Power type and Poke Ball have no place in Pokemon
+// and are skipped
+enum class PackedExtra : std::uint8_t {
+  Happiness,
+  HiddenPowerType,
+  PokeBall,
+  Gigantamax,
+  DynamaxLevel,
+  TeraType
+};
+
+constexpr std::size_t PACKED_EXTRAS = 6;
+
+template <std::size_t N>
+struct PackedParts {
+  std::array<std::string_view, N> text{};
+  // Offset of each part in the text it was split from
+  std::array<std::size_t, N> start{};
+  std::size_t count = 0;
 
-[[nodiscard]] inline bool decode_gigantamax_line(const std::string &line) {
-  try {
-    return decode_bool_line(line, "Gigantamax:");
-  } catch ([[maybe_unused]] const std::runtime_error &e) {
-    throw std::runtime_error{R"(Pokemon Gigantamax line data must be "Yes" or "No")"};
+  template <typename Index>
+  [[nodiscard]] constexpr std::string_view operator[](Index index) const noexcept {
+    const auto i = static_cast<std::size_t>(index);
+    return (i < count) ? text[i] : std::string_view{};
   }
+};
+
+// Splits text on sep, or returns nullopt if it has more than N parts
+template <std::size_t N>
+[[nodiscard]] constexpr std::optional<PackedParts<N>> split_packed(std::string_view text, char sep) noexcept {
+  PackedParts<N> out;
+  std::size_t begin = 0;
+  while (out.count < N) {
+    const auto end         = std::min(text.find(sep, begin), text.size());
+    out.text[out.count]    = text.substr(begin, end - begin);
+    out.start[out.count++] = begin;
+    if (end == text.size()) {
+      return out;
+    }
+    begin = end + 1;
+  }
+  return std::nullopt;
 }
 
-[[nodiscard]] inline std::string encode_tera_type_line(const std::string &tera_type) {
-  return encode_string_line(tera_type, "Tera Type:");
+// Packed numbers are written bare, so error offsets are relative to the number
+[[nodiscard]] inline LineStatus try_decode_packed_number(std::string_view text, int minimum, DecodeErrc too_low, int &out) noexcept {
+  if (const auto code = util::try_to_int(text, out); code != std::errc{}) {
+    return int_error(code, 0);
+  }
+  if (out < minimum) {
+    return LineError{too_low, 0};
+  }
+  return std::nullopt;
 }
 
-[[nodiscard]] inline std::string decode_tera_type_line(
-  const std::string &line
-) {
-  auto value = decode_string_line(line, "Tera Type:");
-  if (value.empty()) {
-    throw std::runtime_error{
-      "Pokemon's Tera Type line must contain a value"
-    };
+// Empty, or six values in Pokemon::Stats order where an empty one keeps its default
+[[nodiscard]] inline LineStatus try_decode_packed_stats(std::string_view text, const Pokemon::Stats &defaults, Pokemon::Stats &out) noexcept {
+  out = defaults;
+  if (text.empty()) {
+    return std::nullopt;
   }
-  return value;
+  const auto parts = split_packed<Pokemon::Stats::NUM_STATS>(text, ',');
+  if (!parts.has_value() || (parts->count != Pokemon::Stats::NUM_STATS)) {
+    return LineError{DecodeErrc::MalformedPackedStats, 0};
+  }
+  for (std::size_t i = 0; i < Pokemon::Stats::NUM_STATS; i++) {
+    if (parts->text[i].empty()) {
+      continue;
+    }
+    int value = 0;
+    if (auto status = try_decode_packed_number(parts->text[i], 0, DecodeErrc::NegativeStat, value)) {
+      status->offset += parts->start[i];
+      return status;
+    }
+    out.*STAT_MEMBERS[i] = static_cast<std::size_t>(value);
+  }
+  return std::nullopt;
 }
 
-[[nodiscard]] inline std::string encode_evs_line(const Pokemon::Stats &evs) {
-  return encode_stat_line(evs, "EVs: ");
+// Showdown packs "Hidden Power [Fire]" as "Hidden Power Fire", as ']' ends a Pokemon, and puts the
+// brackets back when it exports one. These return the type from either spelling
+constexpr std::string_view HIDDEN_POWER = "Hidden Power ";
+
+[[nodiscard]] constexpr std::optional<std::string_view> bracketed_hidden_power(std::string_view move) noexcept {
+  if (!util::starts_with(move, HIDDEN_POWER) || (move.size() < HIDDEN_POWER.size() + 3)) {
+    return std::nullopt;
+  }
+  move.remove_prefix(HIDDEN_POWER.size());
+  if ((move.front() != '[') || (move.back() != ']')) {
+    return std::nullopt;
+  }
+  return move.substr(1, move.size() - 2);
 }
 
-[[nodiscard]] inline Pokemon::Stats decode_evs_line(const std::string &line) {
-  return decode_stat_line(line, "EVs:");
+[[nodiscard]] constexpr std::optional<std::string_view> packed_hidden_power(std::string_view move) noexcept {
+  if (!util::starts_with(move, HIDDEN_POWER) || (move.size() == HIDDEN_POWER.size()) || (move[HIDDEN_POWER.size()] == '[')) {
+    return std::nullopt;
+  }
+  return move.substr(HIDDEN_POWER.size());
 }
 
-[[nodiscard]] inline std::string encode_nature_line(const std::string &nature) {
-  return std::format("{} Nature", nature);
+// Owned Pokemon get the brackets back, so they match what decode_pokemon gives for the same move.
+// Views cannot add text, so keep the packed spelling
+template <typename PokemonT, typename Context>
+[[nodiscard]] bool add_packed_move(Context &context, PokemonT &pokemon, std::string_view move) {
+  if constexpr (std::is_same_v<PokemonT, Pokemon>) {
+    if (const auto type = packed_hidden_power(move)) {
+      std::string restored;
+      restored.reserve(move.size() + 2);
+      restored.append(HIDDEN_POWER).append(1, '[').append(type.value()).append(1, ']');
+      count_growth(pokemon.moves, pokemon.moves.size() + 1);
+      count_new_string(restored.size());
+      pokemon.moves.emplace_back(std::move(restored));
+      return true;
+    }
+  }
+  return add_move(context, pokemon, move);
 }
 
-[[nodiscard]] inline std::string decode_nature_line(const std::string &line) {
-  auto upto  = line.rfind("Nature");
-  auto value = util::trim(line.substr(0, upto));
-  if (value.empty()) {
-    throw std::runtime_error{"Pokemon Nature line must contain a value"};
+// Decodes one packed Pokemon, the text between two ']'. offset is where it starts in its team, which
+// is a single line, so errors report line 1 and the column in the whole team. Like
+// try_decode_pokemon_fields, never throws for malformed input and reaches PokemonT through the
+// assign_text and add_move overloads for Context
+template <typename PokemonT, typename Context = PlainText>
+[[nodiscard]] bool try_decode_packed_fields(std::string_view packed, std::size_t offset, PokemonT &out, std::optional<DecodeError> &error, Context &&context = {}) {
+  const auto fields = split_packed<PACKED_FIELDS>(packed, '|');
+  if (!fields.has_value() || (fields->count != PACKED_FIELDS)) {
+    error = DecodeError{DecodeErrc::MalformedPacked, 1, offset + 1, std::nullopt};
+    return false;
   }
-  return value;
+  const auto field = [&](PackedField index) {
+    return (*fields)[util::to_underlying(index)];
+  };
+  // line_error's offset is relative to the start of the field
+  const auto fail = [&](LineError line_error, PackedField index, std::optional<FieldKind> kind) {
+    error = DecodeError{line_error.code, 1, offset + fields->start[util::to_underlying(index)] + line_error.offset + 1, kind};
+    return false;
+  };
+
+  // The species is left empty when it is the name, which then isn't a nickname
+  const auto name    = field(PackedField::Name);
+  const auto species = field(PackedField::Species);
+  if (species.empty()) {
+    if (name.empty()) {
+      return fail({DecodeErrc::MalformedName}, PackedField::Name, FieldKind::Name);
+    }
+    assign_text(context, out.nickname, std::nullopt);
+    assign_text(context, out.species, name);
+  } else {
+    assign_text(context, out.nickname, name.empty() ? std::nullopt : std::optional{name});
+    assign_text(context, out.species, species);
+  }
+  const auto item = field(PackedField::Item);
+  assign_text(context, out.item, item.empty() ? std::nullopt : std::optional{item});
+
+  const auto ability = field(PackedField::Ability);
+  if (ability.empty()) {
+    return fail({DecodeErrc::MissingAbility}, PackedField::Ability, FieldKind::Ability);
+  }
+  assign_text(context, out.ability, ability);
+
+  if (auto moves = field(PackedField::Moves); !moves.empty()) {
+    std::size_t at = 0;
+    while (true) {
+      const auto end  = std::min(moves.find(',', at), moves.size());
+      const auto move = moves.substr(at, end - at);
+      if (move.empty()) {
+        return fail({DecodeErrc::EmptyMove, at}, PackedField::Moves, FieldKind::Move);
+      }
+      if (!add_packed_move(context, out, move)) {
+        return fail({DecodeErrc::TooManyMoves, at}, PackedField::Moves, FieldKind::Move);
+      }
+      if (end == moves.size()) {
+        break;
+      }
+      at = end + 1;
+    }
+  }
+
+  const auto nature = field(PackedField::Nature);
+  assign_text(context, out.nature, nature.empty() ? std::nullopt : std::optional{nature});
+
+  if (const auto status = try_decode_packed_stats(field(PackedField::EVs), {}, out.evs)) {
+    return fail(status.value(), PackedField::EVs, FieldKind::EVs);
+  }
+
+  // Showdown marks genderless Pokemon N, which is the same as no gender here
+  const auto gender = field(PackedField::Gender);
+  if (gender == "M") {
+    out.gender = Gender::M;
+  } else if (gender == "F") {
+    out.gender = Gender::F;
+  } else if (gender.empty() || (gender == "N")) {
+    out.gender = std::nullopt;
+  } else {
+    return fail({DecodeErrc::InvalidPackedGender}, PackedField::Gender, FieldKind::Name);
+  }
+
+  if (const auto status = try_decode_packed_stats(field(PackedField::IVs), Pokemon::DEFAULT_IVS, out.ivs)) {
+    return fail(status.value(), PackedField::IVs, FieldKind::IVs);
+  }
+
+  const auto shiny = field(PackedField::Shiny);
+  if (!shiny.empty() && (shiny != "S")) {
+    return fail({DecodeErrc::InvalidPackedShiny}, PackedField::Shiny, FieldKind::Shiny);
+  }
+  out.shiny = !shiny.empty();
+
+  out.level = std::nullopt;
+  if (const auto level = field(PackedField::Level); !level.empty()) {
+    int value = 0;
+    if (const auto status = try_decode_packed_number(level, 1, DecodeErrc::LevelTooLow, value)) {
+      return fail(status.value(), PackedField::Level, FieldKind::Level);
+    }
+    out.level = static_cast<std::size_t>(value);
+  }
+
+  const auto misc   = field(PackedField::Misc);
+  const auto extras = split_packed<PACKED_EXTRAS>(misc, ',');
+  if (!extras.has_value()) {
+    return fail({DecodeErrc::MalformedPacked}, PackedField::Misc, std::nullopt);
+  }
+  const auto fail_extra = [&](LineError line_error, PackedExtra index, std::optional<FieldKind> kind) {
+    line_error.offset += extras->start[util::to_underlying(index)];
+    return fail(line_error, PackedField::Misc, kind);
+  };
+  const auto extra = [&](PackedExtra index) {
+    return (*extras)[util::to_underlying(index)];
+  };
+
+  out.happiness = Pokemon::DEFAULT_HAPPINESS;
+  if (const auto happiness = extra(PackedExtra::Happiness); !happiness.empty()) {
+    int value = 0;
+    if (const auto status = try_decode_packed_number(happiness, 1, DecodeErrc::HappinessTooLow, value)) {
+      return fail_extra(status.value(), PackedExtra::Happiness, FieldKind::Happiness);
+    }
+    out.happiness = static_cast<std::size_t>(value);
+  }
+
+  const auto gigantamax = extra(PackedExtra::Gigantamax);
+  if (!gigantamax.empty() && (gigantamax != "G")) {
+    return fail_extra({DecodeErrc::InvalidPackedGigantamax}, PackedExtra::Gigantamax, FieldKind::Gigantamax);
+  }
+  out.gigantamax = !gigantamax.empty();
+
+  out.dynamax_level = Pokemon::DEFAULT_DYNAMAX_LEVEL;
+  if (const auto dynamax_level = extra(PackedExtra::DynamaxLevel); !dynamax_level.empty()) {
+    int value = 0;
+    if (const auto status = try_decode_packed_number(dynamax_level, 1, DecodeErrc::DynamaxLevelTooLow, value)) {
+      return fail_extra(status.value(), PackedExtra::DynamaxLevel, FieldKind::DynamaxLevel);
+    }
+    out.dynamax_level = static_cast<std::size_t>(value);
+  }
+
+  const auto tera_type = extra(PackedExtra::TeraType);
+  assign_text(context, out.tera_type, tera_type.empty() ? std::nullopt : std::optional{tera_type});
+  return true;
 }
 
-[[nodiscard]] inline std::string encode_ivs_line(const Pokemon::Stats &ivs) {
-  return encode_stat_line(ivs, "IVs: ", Pokemon::DEFAULT_IVS);
+// Decodes the Pokemon starting at pos in team, then moves pos past the ']' ending it, or to npos if
+// it was the last
+template <typename PokemonT, typename Context = PlainText>
+[[nodiscard]] bool try_decode_next_packed(std::string_view team, std::size_t &pos, PokemonT &out, std::optional<DecodeError> &error, Context &&context = {}) {
+  const auto end     = std::min(team.find(']', pos), team.size());
+  const auto decoded = try_decode_packed_fields(team.substr(pos, end - pos), pos, out, error, context);
+  pos                = (end == team.size()) ? std::string_view::npos : end + 1;
+  return decoded;
 }
 
-[[nodiscard]] inline Pokemon::Stats decode_ivs_line(const std::string &line) {
-  return decode_stat_line(line, "IVs:", Pokemon::DEFAULT_IVS);
+// Pokemon are separated, not terminated, by ']', so only an empty team has none
+template <typename PokemonT, typename Context = PlainText>
+[[nodiscard]] std::vector<PokemonT> try_decode_all_packed(std::string_view team, std::optional<DecodeError> &error, Context &&context = {}) {
+  std::vector<PokemonT> out;
+  if (team.empty()) {
+    return out;
+  }
+  for (std::size_t pos = 0; pos != std::string_view::npos;) {
+    PokemonT pokemon;
+    if (!try_decode_next_packed(team, pos, pokemon, error, context)) {
+      return out;
+    }
+    out.push_back(std::move(pokemon));
+  }
+  return out;
 }
 
-[[nodiscard]] inline std::string encode_move_line(const std::string &move) {
-  return encode_string_line(move, "-");
+template <typename PokemonT, typename Context = PlainText>
+[[nodiscard]] std::vector<PokemonT> decode_all_packed(std::string_view team, Context &&context = {}) {
+  std::optional<DecodeError> error;
+  auto out = try_decode_all_packed<PokemonT>(team, error, context);
+  if (error.has_value()) {
+    throw_decode_error(error->code);
+  }
+  return out;
 }
 
-[[nodiscard]] inline std::string decode_move_line(const std::string &line) {
-  auto value = decode_string_line(line, "-");
-  if (value.empty()) {
-    throw std::runtime_error{"Pokemon Move line must contain a value"};
+// Text a packed Pokemon holds has to leave its separators unambiguous
+inline void check_packed_text(std::string_view text, bool in_list) {
+  if (text.find_first_of("|]") != std::string_view::npos) {
+    throw domain_bound_error{"Packed text cannot contain '|' or ']'"};
+  }
+  if (in_list && (text.find(',') != std::string_view::npos)) {
+    throw domain_bound_error{"Packed moves and Tera Types cannot contain ','"};
   }
-  return value;
 }
 
-} // namespace detail
+template <typename OutputIt>
+OutputIt write_packed_text(OutputIt out, std::string_view text, bool in_list = false) {
+  check_packed_text(text, in_list);
+  return write_text(out, text);
+}
 
-[[nodiscard]] inline std::string encode_pokemon(const Pokemon &pokemon) {
-  std::vector<std::string> parts;
-  parts.push_back(
-    detail::encode_name_line(
-      detail::SpeciesLineInfo{
-        pokemon.nickname,
-        pokemon.species,
-        pokemon.gender,
-        pokemon.item
-      }
-    )
-  );
-  parts.push_back(detail::encode_ability_line(pokemon.ability));
-  if (pokemon.level.has_value()) {
-    parts.push_back(detail::encode_level_line(pokemon.level.value()));
-  }
-  if (pokemon.shiny) {
-    parts.push_back(detail::encode_shiny_line(pokemon.shiny));
+// Nothing for an empty one
+template <typename OutputIt>
+OutputIt write_packed_optional(OutputIt out, const std::optional<std::string> &text, bool in_list = false) {
+  return text.has_value() ? write_packed_text(out, text.value(), in_list) : out;
+}
+
+// Empty when every stat is its default, otherwise six values with the defaults left empty
+template <typename OutputIt>
+OutputIt write_packed_stats(OutputIt out, const Pokemon::Stats &stats, const Pokemon::Stats &defaults) {
+  if (stats == defaults) {
+    return out;
   }
-  if (pokemon.happiness != Pokemon::DEFAULT_HAPPINESS) {
-    parts.push_back(detail::encode_happiness_line(pokemon.happiness));
+  for (std::size_t i = 0; i < Pokemon::Stats::NUM_STATS; i++) {
+    if (i > 0) {
+      *out++ = ',';
+    }
+    if (stats.*STAT_MEMBERS[i] != defaults.*STAT_MEMBERS[i]) {
+      out = write_number(out, stats.*STAT_MEMBERS[i]);
+    }
   }
-  if (pokemon.dynamax_level != Pokemon::DEFAULT_DYNAMAX_LEVEL) {
-    parts.push_back(detail::encode_dynamax_level_line(pokemon.dynamax_level));
+  return out;
+}
+
+// Names are written as they are rather than as the lowercase IDs Showdown packs them to, which its
+// unpacker also accepts, so that they decode back exactly. Level is written even at 100, so a Pokemon
+// without one stays without one. Hidden Power loses its brackets like it does in Showdown
+template <typename OutputIt>
+OutputIt encode_packed_fields_to(OutputIt out, const Pokemon &pokemon) {
+  if (pokemon.nickname.has_value()) {
+    out    = write_packed_text(out, pokemon.nickname.value());
+    *out++ = '|';
+    out    = write_packed_text(out, pokemon.species);
+  } else {
+    out    = write_packed_text(out, pokemon.species);
+    *out++ = '|';
   }
-  if (pokemon.gigantamax) {
-    parts.push_back(detail::encode_gigantamax_line(pokemon.gigantamax));
+  *out++ = '|';
+  out    = write_packed_optional(out, pokemon.item);
+  *out++ = '|';
+  out    = write_packed_text(out, pokemon.ability);
+  *out++ = '|';
+  for (std::size_t i = 0; i < pokemon.moves.size(); i++) {
+    if (i > 0) {
+      *out++ = ',';
+    }
+    const auto type = bracketed_hidden_power(pokemon.moves[i]);
+    if (type.has_value()) {
+      out = write_text(out, HIDDEN_POWER);
+    }
+    out = write_packed_text(out, type.value_or(pokemon.moves[i]), true);
   }
-  if (pokemon.tera_type.has_value()) {
-    parts.push_back(detail::encode_tera_type_line(pokemon.tera_type.value()));
+  *out++ = '|';
+  out    = write_packed_optional(out, pokemon.nature);
+  *out++ = '|';
+  out    = write_packed_stats(out, pokemon.evs, {});
+  *out++ = '|';
+  if (pokemon.gender.has_value()) {
+    *out++ = (pokemon.gender == Gender::F) ? 'F' : 'M';
   }
-  if (pokemon.evs != Pokemon::Stats{0, 0, 0, 0, 0, 0}) {
-    parts.push_back(detail::encode_evs_line(pokemon.evs));
+  *out++ = '|';
+  out    = write_packed_stats(out, pokemon.ivs, Pokemon::DEFAULT_IVS);
+  *out++ = '|';
+  if (pokemon.shiny) {
+    *out++ = 'S';
   }
-  if (pokemon.nature.has_value()) {
-    parts.push_back(detail::encode_nature_line(pokemon.nature.value()));
+  *out++ = '|';
+  if (pokemon.level.has_value()) {
+    out = write_number(out, pokemon.level.value());
   }
-  if (pokemon.ivs != Pokemon::DEFAULT_IVS) {
-    parts.push_back(detail::encode_ivs_line(pokemon.ivs));
+  *out++ = '|';
+  if (pokemon.happiness != Pokemon::DEFAULT_HAPPINESS) {
+    out = write_number(out, pokemon.happiness);
   }
-  for (const auto &move : pokemon.moves) {
-    parts.push_back(detail::encode_move_line(move));
+  if (pokemon.gigantamax || (pokemon.dynamax_level != Pokemon::DEFAULT_DYNAMAX_LEVEL) || pokemon.tera_type.has_value()) {
+    // No Hidden Power type or Poke Ball
+    out = write_text(out, ",,,");
+    if (pokemon.gigantamax) {
+      *out++ = 'G';
+    }
+    *out++ = ',';
+    if (pokemon.dynamax_level != Pokemon::DEFAULT_DYNAMAX_LEVEL) {
+      out = write_number(out, pokemon.dynamax_level);
+    }
+    *out++ = ',';
+    out    = write_packed_optional(out, pokemon.tera_type, true);
   }
-  return util::join(parts, "\n");
+  return out;
 }
 
-[[nodiscard]] inline Pokemon decode_pokemon(const std::string &data) {
-  Pokemon out;
-  const auto fixed_newlines = util::join(util::split(data, "\r\n"), "\n");
-  auto parts                = util::split(util::trim(fixed_newlines), "\n");
-  if (util::trim(parts.back()).empty()) {
-    parts.pop_back();
-  }
-  if (parts.size() <= 1) {
-    throw std::runtime_error{"Not enough lines in Pokemon data"};
-  }
-  const auto &[nickname, species, gender, item] = detail::decode_name_line(parts.front());
-  out.nickname                                  = nickname;
-  out.species                                   = species;
-  out.gender                                    = gender;
-  out.item                                      = item;
-
-  std::unordered_set<std::string> found;
-  const auto body = std::span{parts}.subspan(1, parts.size() - 1);
-  for (const auto &raw_line : body) {
-    const auto line = util::trim(raw_line);
-    std::optional<std::string> key;
-    if (util::starts_with(line, "Ability:")) {
-      key         = "Ability";
-      out.ability = detail::decode_ability_line(line);
-    } else if (util::starts_with(line, "Level:")) {
-      key       = "Level";
-      out.level = detail::decode_level_line(line);
-    } else if (util::starts_with(line, "Shiny:")) {
-      key       = "Shiny";
-      out.shiny = detail::decode_shiny_line(line);
-    } else if (util::starts_with(line, "Happiness:")) {
-      key           = "Happiness";
-      out.happiness = detail::decode_happiness_line(line);
-    } else if (util::starts_with(line, "Dynamax Level:")) {
-      key               = "Dynamax Level";
-      out.dynamax_level = detail::decode_dynamax_level_line(line);
-    } else if (util::starts_with(line, "Gigantamax:")) {
-      key            = "Gigantamax";
-      out.gigantamax = detail::decode_gigantamax_line(line);
-    } else if (util::starts_with(line, "Tera Type:")) {
-      key           = "Tera Type";
-      out.tera_type = detail::decode_tera_type_line(line);
-    } else if (util::starts_with(line, "EVs:")) {
-      key     = "EVs";
-      out.evs = detail::decode_evs_line(line);
-    } else if (util::ends_with(line, "Nature")) {
-      key        = "Nature";
-      out.nature = detail::decode_nature_line(line);
-    } else if (util::starts_with(line, "IVs:")) {
-      key     = "IVs";
-      out.ivs = detail::decode_ivs_line(line);
-    } else if (util::starts_with(line, "-")) {
-      out.moves.push_back(detail::decode_move_line(line));
-    } else {
-      throw std::runtime_error{"Unknown line in Pokemon data"};
-    }
-    if (key.has_value()) {
-      if (found.contains(key.value())) {
-        throw std::runtime_error{"Duplicate line detected"};
-      }
-      found.insert(key.value());
+} // namespace detail
+
+// Writes pokemon in Pokemon Showdown's packed format through out. Throws domain_bound_error if a name
+// holds one of the format's separators
+template <typename OutputIt>
+OutputIt encode_packed_to(OutputIt out, const Pokemon &pokemon) {
+  return detail::encode_packed_fields_to(out, pokemon);
+}
+
+// Pokemon separated by ']'
+template <typename OutputIt>
+OutputIt encode_packed_to(OutputIt out, const PokePaste &paste) {
+  for (std::size_t i = 0; i < paste.size(); i++) {
+    if (i > 0) {
+      *out++ = ']';
     }
+    out = encode_packed_to(out, paste[i]);
   }
+  return out;
+}
 
-  if (!found.contains("Ability")) {
-    throw std::runtime_error{"Pokemon requires Ability data"};
-  }
+// Exact length of encode_packed's result, without encoding it
+[[nodiscard]] inline std::size_t packed_size(const Pokemon &pokemon) {
+  return encode_packed_to(detail::SizeCounter{}, pokemon).size();
+}
+
+[[nodiscard]] inline std::size_t packed_size(const PokePaste &paste) {
+  return encode_packed_to(detail::SizeCounter{}, paste).size();
+}
 
+// The single line form Pokemon Showdown moves teams around in, which is smaller and cheaper to parse
+// than the multi line form encode_pokemon writes. Every field survives decode_packed
+[[nodiscard]] inline std::string encode_packed(const Pokemon &pokemon) {
+  std::string out;
+  out.reserve(packed_size(pokemon));
+  encode_packed_to(std::back_inserter(out), pokemon);
   return out;
 }
 
-[[nodiscard]] inline std::string encode_pokepaste(const PokePaste &paste) {
+[[nodiscard]] inline std::string encode_packed(const PokePaste &paste) {
   std::string out;
-  for (const auto &pokemon : paste) {
-    out.append(std::format("{}\n\n", util::trim(encode_pokemon(pokemon))));
+  out.reserve(packed_size(paste));
+  encode_packed_to(std::back_inserter(out), paste);
+  return out;
+}
+
+// Decodes a packed team the way Pokemon Showdown writes them, including the lowercase IDs it packs
+// names to, which are kept as they are. Hidden Power types and Poke Balls are skipped. Errors are
+// reported on line 1, at the column in team
+[[nodiscard]] inline TryDecodeResult<PokePaste> try_decode_packed(std::string_view team) {
+  TryDecodeResult<PokePaste> out;
+  out.value = detail::try_decode_all_packed<Pokemon>(team, out.error);
+  if (!out.ok()) {
+    out.value.clear();
   }
-  return util::trim(out);
+  return out;
 }
 
-[[nodiscard]] inline PokePaste decode_pokepaste(const std::string &paste) {
-  PokePaste out;
-  const auto fixed_newlines = util::join(util::split(paste, "\r\n"), "\n");
-  const auto split_newlines = util::split(fixed_newlines, "\n\n");
-  std::vector<std::string> team;
-  for (const auto &pokemon : split_newlines) {
-    const auto trimmed = util::trim(pokemon);
-    if (!trimmed.empty()) {
-      team.push_back(trimmed);
+// Throws like decode_pokepaste if team is malformed
+[[nodiscard]] inline PokePaste decode_packed(std::string_view team) {
+  return detail::decode_all_packed<Pokemon>(team);
+}
+
+// A lone packed Pokemon, with no ']'
+[[nodiscard]] inline Pokemon decode_packed_pokemon(std::string_view packed) {
+  Pokemon out;
+  std::optional<DecodeError> error;
+  if (!detail::try_decode_packed_fields(packed, 0, out, error)) {
+    detail::throw_decode_error(error->code);
+  }
+  return out;
+}
+
+// Decodes team without copying any text, so the result must not outlive it. Throws
+// domain_bound_error for Pokemon with more than 4 moves, like decode_pokepaste_view
+[[nodiscard]] inline PokePasteView decode_packed_view(std::string_view team) {
+  return detail::decode_all_packed<PokemonView>(team);
+}
+
+// Pull decoder over a whole packed team that decodes one Pokemon per call to next(), without
+// copying text or allocating, so each view must not outlive team
+class PackedTeamReader {
+public:
+  explicit PackedTeamReader(std::string_view team) noexcept : team_{team}, pos_{team.empty() ? std::string_view::npos : 0} {}
+
+  // The next Pokemon, or nullopt once there are none left. Throws like decode_packed_view, after
+  // which there are none left
+  [[nodiscard]] std::optional<PokemonView> next() {
+    if (pos_ == std::string_view::npos) {
+      return std::nullopt;
+    }
+    PokemonView out;
+    std::optional<DecodeError> error;
+    if (!detail::try_decode_next_packed(team_, pos_, out, error)) {
+      pos_ = std::string_view::npos;
+      detail::throw_decode_error(error->code);
+    }
+    return out;
+  }
+
+private:
+  std::string_view team_;
+  std::size_t pos_;
+};
+
+// Push decoder for packed teams that arrive in arbitrary pieces, eg. from a socket. Each Pokemon is
+// passed to the callback as soon as the ']' ending it is fed, decoded exactly like decode_packed
+// would. One that lies wholly within a chunk is decoded straight from it, so only a Pokemon split
+// across chunks, or the last one, which waits for finish(), is ever copied before decoding
+class PackedStreamDecoder {
+public:
+  using Callback = std::function<void(Pokemon)>;
+
+  explicit PackedStreamDecoder(Callback on_pokemon) : on_pokemon_{std::move(on_pokemon)} {}
+
+  void feed(std::string_view chunk) {
+    fed_ = fed_ || !chunk.empty();
+    while (true) {
+      const auto end = chunk.find(']');
+      if (end == std::string_view::npos) {
+        buffer_.append(chunk);
+        return;
+      }
+      if (buffer_.empty()) {
+        emit(chunk.substr(0, end));
+      } else {
+        buffer_.append(chunk.substr(0, end));
+        emit(buffer_);
+      }
+      chunk.remove_prefix(end + 1);
+    }
+  }
+
+  // Decodes the last Pokemon once the input is exhausted, as no ']' follows it
+  void finish() {
+    if (fed_) {
+      emit(buffer_);
     }
+    reset();
   }
-  for (const auto &pokemon : team) {
-    out.push_back(decode_pokemon(util::trim(pokemon)));
+
+private:
+  // Errors drop the rest of the team, leaving the decoder ready for the next
+  void emit(std::string_view packed) {
+    Pokemon pokemon;
+    std::optional<DecodeError> error;
+    if (!detail::try_decode_packed_fields(packed, 0, pokemon, error)) {
+      reset();
+      detail::throw_decode_error(error->code);
+    }
+    buffer_.clear();
+    on_pokemon_(std::move(pokemon));
   }
 
-  return out;
-}
+  void reset() noexcept {
+    buffer_.clear();
+    fed_ = false;
+  }
+
+  Callback on_pokemon_;
+  std::string buffer_;
+  // Whether finish() has a last Pokemon to decode, even an empty one
+  bool fed_ = false;
+};
 
 } // namespace pokepaste
 
@@ -0,0 +1,284 @@
+#ifndef NGL_POKEPASTE_SYNTHETIC_HPP
+#define NGL_POKEPASTE_SYNTHETIC_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ngl-pokepaste/pokepaste.hpp"
+
+// Deterministic generator of realistic PokePastes for benchmarks and stress tests. The same seed and
+// options produce the same text on every platform, since nothing depends on the standard library's
+// random distributions
+namespace ngl::pokepaste::synthetic {
+
+// Rates are probabilities in [0, 1]
+struct Options {
+  std::uint64_t seed = 0;
+  // Pokemon per paste, inclusive
+  std::size_t min_pokemon = 1;
+  std::size_t max_pokemon = 6;
+  // Moves per Pokemon, inclusive. More than 4 is accepted by the decoder, if not by the games
+  std::size_t min_moves = 1;
+  std::size_t max_moves = 4;
+  double nickname_rate  = 0.3;
+  double gender_rate    = 0.3;
+  double item_rate      = 0.9;
+  // Chance of each of Level, Shiny, Happiness, Dynamax Level, Gigantamax, Tera Type, EVs, Nature and
+  // IVs appearing
+  double optional_field_rate = 0.5;
+  // Chance of a paste using CRLF line endings
+  double crlf_rate = 0.0;
+  // Chance of a paste having one malformed Pokemon
+  double malformed_rate = 0.0;
+};
+
+struct GeneratedPaste {
+  std::string text;
+  // What decode_pokepaste returns for text, or decode_pokepaste_recovering if it is malformed
+  PokePaste pokemon;
+  // Block index of the malformed Pokemon, if there is one
+  std::optional<std::size_t> malformed;
+};
+
+namespace detail {
+
+// SplitMix64, which is tiny, fast and fully specified, so output never varies by platform
+class Random {
+public:
+  explicit Random(std::uint64_t seed) noexcept : state_{seed} {}
+
+  [[nodiscard]] std::uint64_t next() noexcept {
+    state_ += 0x9E3779B97F4A7C15ULL;
+    auto z = state_;
+    z      = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+    z      = (z ^ (z >> 27U)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31U);
+  }
+
+  // Uniform in [0, bound); the modulo bias is irrelevant for bounds this small
+  [[nodiscard]] std::size_t below(std::size_t bound) noexcept {
+    return static_cast<std::size_t>(next() % bound);
+  }
+
+  // Uniform in [min, max], which must not span every std::size_t
+  [[nodiscard]] std::size_t between(std::size_t min, std::size_t max) noexcept {
+    return min + below(max - min + 1);
+  }
+
+  [[nodiscard]] bool chance(double rate) noexcept {
+    return (static_cast<double>(next() >> 11U) * 0x1.0p-53) < rate;
+  }
+
+  template <typename T, std::size_t N>
+  [[nodiscard]] const T &pick(const std::array<T, N> &values) noexcept {
+    return values[below(N)];
+  }
+
+private:
+  std::uint64_t state_;
+};
+
+// Names that exercise the name line parser: punctuation, spaces, hyphens, colons and UTF-8
+constexpr std::array<std::string_view, 32> SPECIES = {
+  "Garchomp", "Mr. Mime", "Ho-Oh", "Type: Null", "Farfetch’d", "Porygon-Z", "Kommo-o", "Tapu Koko",
+  "Urshifu-Rapid-Strike", "Iron Hands", "Flutter Mane", "Amoonguss", "Incineroar", "Rillaboom",
+  "Landorus-Therian", "Tornadus", "Calyrex-Shadow", "Zacian-Crowned", "Indeedee-F", "Nidoran-M",
+  "Sinistcha", "Chien-Pao", "Dragonite", "Gholdengo", "Pikachu", "Charizard", "Tyranitar", "Jirachi",
+  "Smeargle", "Ursaluna-Bloodmoon", "Ogerpon-Hearthflame", "Great Tusk"
+};
+
+// Includes parenthesised nicknames that still decode unambiguously
+constexpr std::array<std::string_view, 12> NICKNAMES = {
+  "Chompy", "(Chompy)", "Sir Fluffington", ":)", "(._.)", "x)(x", "Big Guy)", "Mr. Smile",
+  "The Wall", "@home", "Nick-Name", "★Star★"
+};
+
+constexpr std::array<std::string_view, 16> ITEMS = {
+  "Choice Scarf", "Choice Specs", "Leftovers", "Life Orb", "Focus Sash", "Sitrus Berry",
+  "Assault Vest", "Booster Energy", "Covert Cloak", "Safety Goggles", "Rocky Helmet", "Clear Amulet",
+  "Mirror Herb", "Loaded Dice", "Heavy-Duty Boots", "King's Rock"
+};
+
+constexpr std::array<std::string_view, 16> ABILITIES = {
+  "Intimidate", "Rough Skin", "Prankster", "Protosynthesis", "Quark Drive", "Regenerator",
+  "Good as Gold", "Multiscale", "Sand Stream", "Serene Grace", "Unseen Fist", "As One (Spectrier)",
+  "Inner Focus", "Sword of Ruin", "Mind's Eye", "Drought"
+};
+
+constexpr std::array<std::string_view, 19> TYPES = {
+  "Normal", "Fire", "Water", "Electric", "Grass", "Ice", "Fighting", "Poison", "Ground", "Flying",
+  "Psychic", "Bug", "Rock", "Ghost", "Dragon", "Dark", "Steel", "Fairy", "Stellar"
+};
+
+constexpr std::array<std::string_view, 25> NATURES = {
+  "Hardy", "Lonely", "Brave", "Adamant", "Naughty", "Bold", "Docile", "Relaxed", "Impish", "Lax",
+  "Timid", "Hasty", "Serious", "Jolly", "Naive", "Modest", "Mild", "Quiet", "Bashful", "Rash", "Calm",
+  "Gentle", "Sassy", "Careful", "Quirky"
+};
+
+constexpr std::array<std::string_view, 24> MOVES = {
+  "Protect", "Earthquake", "Swords Dance", "Fake Out", "Close Combat", "Shadow Ball", "U-turn",
+  "Will-O-Wisp", "Trick Room", "Tailwind", "Knock Off", "Stealth Rock", "Hidden Power [Fire]",
+  "Moonblast", "Extreme Speed", "Wicked Blow", "Surging Strikes", "Make It Rain", "Nasty Plot",
+  "Draco Meteor", "Spore", "Rage Powder", "Heat Wave", "Double-Edge"
+};
+
+// Lines appended to, or replacing, a Pokemon's own to make it fail to decode
+constexpr std::array<std::string_view, 6> MALFORMED_LINES = {
+  "Unknown Field: Value", "Level: abc", "Ability: Duplicate", "EVs: 252 Foo", "- ", "Happiness: 0"
+};
+
+} // namespace detail
+
+class Generator {
+public:
+  // Throws std::invalid_argument if a range is empty or too wide to pick from, or if pastes could
+  // never hold a Pokemon
+  explicit Generator(Options options) : options_{options}, random_{options.seed} {
+    check_range(options_.min_pokemon, options_.max_pokemon, "Pokemon");
+    check_range(options_.min_moves, options_.max_moves, "moves");
+    if (options_.max_pokemon == 0) {
+      throw std::invalid_argument{"Generated pastes must be allowed at least one Pokemon"};
+    }
+  }
+
+  // A Pokemon that encodes and decodes back to itself
+  [[nodiscard]] Pokemon pokemon() {
+    Pokemon out;
+    out.species = random_.pick(detail::SPECIES);
+    if (random_.chance(options_.nickname_rate)) {
+      out.nickname = random_.pick(detail::NICKNAMES);
+    }
+    if (random_.chance(options_.gender_rate)) {
+      out.gender = random_.chance(0.5) ? Gender::M : Gender::F;
+    }
+    if (random_.chance(options_.item_rate)) {
+      out.item = random_.pick(detail::ITEMS);
+    }
+    out.ability = random_.pick(detail::ABILITIES);
+    if (optional_field()) {
+      out.level = random_.between(1, 100);
+    }
+    out.shiny = optional_field();
+    if (optional_field()) {
+      out.happiness = random_.between(1, Pokemon::DEFAULT_HAPPINESS - 1);
+    }
+    if (optional_field()) {
+      out.dynamax_level = random_.between(1, Pokemon::DEFAULT_DYNAMAX_LEVEL - 1);
+    }
+    out.gigantamax = optional_field();
+    if (optional_field()) {
+      out.tera_type = random_.pick(detail::TYPES);
+    }
+    if (optional_field()) {
+      out.evs = stats({}, 63, 4);
+    }
+    if (optional_field()) {
+      out.nature = random_.pick(detail::NATURES);
+    }
+    if (optional_field()) {
+      out.ivs = stats(Pokemon::DEFAULT_IVS, 31, 1);
+    }
+    const auto moves = random_.between(options_.min_moves, options_.max_moves);
+    for (std::size_t i = 0; i < moves; i++) {
+      out.moves.emplace_back(random_.pick(detail::MOVES));
+    }
+    return out;
+  }
+
+  [[nodiscard]] GeneratedPaste paste() {
+    GeneratedPaste out;
+    const auto count = random_.between(options_.min_pokemon, options_.max_pokemon);
+    if ((count > 0) && random_.chance(options_.malformed_rate)) {
+      out.malformed = random_.below(count);
+    }
+    const auto crlf = random_.chance(options_.crlf_rate);
+    for (std::size_t i = 0; i < count; i++) {
+      if (i > 0) {
+        out.text.append(crlf ? "\r\n\r\n" : "\n\n");
+      }
+      auto pokemon = this->pokemon();
+      auto text    = encode_pokemon(pokemon);
+      if (out.malformed == i) {
+        malform(text);
+      } else {
+        out.pokemon.push_back(std::move(pokemon));
+      }
+      append_text(out.text, text, crlf);
+    }
+    return out;
+  }
+
+  // Pastes until their text totals at least min_bytes. Joined by empty lines, they form one large paste
+  [[nodiscard]] std::vector<GeneratedPaste> corpus(std::size_t min_bytes) {
+    std::vector<GeneratedPaste> out;
+    std::size_t bytes = 0;
+    while (bytes < min_bytes) {
+      out.push_back(paste());
+      bytes += out.back().text.size();
+    }
+    return out;
+  }
+
+private:
+  static void check_range(std::size_t min, std::size_t max, const std::string &what) {
+    if (min > max) {
+      throw std::invalid_argument{"Minimum " + what + " exceeds the maximum"};
+    }
+    if ((max - min) == std::numeric_limits<std::size_t>::max()) {
+      throw std::invalid_argument{"Range of " + what + " is too wide"};
+    }
+  }
+
+  [[nodiscard]] bool optional_field() noexcept {
+    return random_.chance(options_.optional_field_rate);
+  }
+
+  // About half of base's stats replaced by random multiples of step
+  [[nodiscard]] Pokemon::Stats stats(Pokemon::Stats base, std::size_t max_steps, std::size_t step) noexcept {
+    for (auto *stat : {&base.hp, &base.atk, &base.def, &base.spatk, &base.spdef, &base.spd}) {
+      if (random_.chance(0.5)) {
+        *stat = random_.between(0, max_steps) * step;
+      }
+    }
+    return base;
+  }
+
+  void malform(std::string &text) {
+    const auto line = random_.pick(detail::MALFORMED_LINES);
+    // Dropping the Ability line instead leaves a Pokemon missing required data
+    if (random_.chance(0.2)) {
+      const auto begin = text.find("\nAbility: ");
+      text.erase(begin, text.find('\n', begin + 1) - begin);
+      return;
+    }
+    text.append("\n").append(line);
+  }
+
+  static void append_text(std::string &out, std::string_view text, bool crlf) {
+    if (!crlf) {
+      out.append(text);
+      return;
+    }
+    for (const auto c : text) {
+      if (c == '\n') {
+        out.push_back('\r');
+      }
+      out.push_back(c);
+    }
+  }
+
+  Options options_;
+  detail::Random random_;
+};
+
+} // namespace ngl::pokepaste::synthetic
+
+#endif
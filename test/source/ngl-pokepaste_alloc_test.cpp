@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ngl-pokepaste/file.hpp"
+#include "ngl-pokepaste/pokepaste.hpp"
+#include "ngl-pokepaste/synthetic.hpp"
+
+// Bounds on the allocations each API makes, so that one creeping into a fast path fails the tests.
+// Every allocation made through the global operator new is counted; the bounds are worked out from
+// what is decoded rather than fixed, so they hold on every standard library
+
+namespace {
+std::atomic<std::size_t> allocation_count{0};
+} // namespace
+
+void *operator new(std::size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size == 0 ? 1 : size)) { // NOLINT(cppcoreguidelines-no-malloc)
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+void *operator new[](std::size_t size) {
+  return ::operator new(size);
+}
+
+// Once this is inlined next to the operator new above, GCC takes the free for a mismatched delete,
+// not knowing that operator new hands out malloc'd memory
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void *ptr) noexcept {
+  std::free(ptr); // NOLINT(cppcoreguidelines-no-malloc)
+}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+void operator delete[](void *ptr) noexcept {
+  ::operator delete(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept {
+  ::operator delete(ptr);
+}
+
+void operator delete[](void *ptr, std::size_t) noexcept {
+  ::operator delete(ptr);
+}
+
+namespace {
+
+std::size_t failures = 0; // NOLINT
+
+// Fails the run if fn allocates more than bound times
+template <typename Fn>
+void check_at_most(std::string_view api, std::string_view input, std::size_t bound, Fn &&fn) {
+  const auto before = allocation_count.load(std::memory_order_relaxed);
+  fn();
+  const auto allocations = allocation_count.load(std::memory_order_relaxed) - before;
+  if (allocations > bound) {
+    std::cout << api << " made " << allocations << " allocations for " << input << ", expected at most " << bound << "\n";
+    failures++;
+  }
+}
+
+// Allocations a vector makes growing from capacity to hold size elements one at a time, assuming the
+// slowest growth any standard library uses, 1.5x
+[[nodiscard]] std::size_t growths(std::size_t capacity, std::size_t size) {
+  std::size_t out = 0;
+  while (capacity < size) {
+    capacity = std::max(capacity + 1, capacity + (capacity / 2));
+    out++;
+  }
+  return out;
+}
+
+[[nodiscard]] std::size_t string_allocations(std::string_view text) {
+  return text.size() > std::string{}.capacity() ? 1 : 0;
+}
+
+// The move list only allocates once it spills past its inline moves
+[[nodiscard]] std::size_t move_list_allocations(std::size_t moves) {
+  constexpr auto inline_moves = ngl::pokepaste::Pokemon::INLINE_MOVES;
+  return moves > inline_moves ? 1 + growths(2 * inline_moves, moves) : 0;
+}
+
+[[nodiscard]] std::size_t owned_allocations(const ngl::pokepaste::Pokemon &pokemon) {
+  std::size_t out = 0;
+  for (const auto &text : {pokemon.nickname, pokemon.item, pokemon.tera_type, pokemon.nature}) {
+    out += string_allocations(text.value_or(""));
+  }
+  out += string_allocations(pokemon.species) + string_allocations(pokemon.ability);
+  for (const auto &move : pokemon.moves) {
+    out += string_allocations(move);
+  }
+  return out + move_list_allocations(pokemon.moves.size());
+}
+
+[[nodiscard]] std::size_t owned_allocations(const ngl::pokepaste::PokePaste &paste) {
+  auto out = growths(0, paste.size());
+  for (const auto &pokemon : paste) {
+    out += owned_allocations(pokemon);
+  }
+  return out;
+}
+
+void check_paste(std::string_view name, std::string_view text) {
+  namespace pokepaste = ngl::pokepaste;
+  const auto paste    = pokepaste::decode_pokepaste(text);
+
+  check_at_most("decode_pokepaste", name, owned_allocations(paste), [&] {
+    (void)pokepaste::decode_pokepaste(text);
+  });
+  check_at_most("try_decode_pokepaste", name, owned_allocations(paste), [&] {
+    (void)pokepaste::try_decode_pokepaste(text);
+  });
+  // Only the vector of views allocates
+  const auto fits_view = std::ranges::all_of(paste, [](const auto &pokemon) {
+    return pokemon.moves.size() <= pokepaste::PokemonView::MAX_MOVES;
+  });
+  if (fits_view) {
+    check_at_most("decode_pokepaste_view", name, growths(0, paste.size()), [&] {
+      (void)pokepaste::decode_pokepaste_view(text);
+    });
+  }
+
+  // Once warmed up, decoding the same paste into the same objects allocates nothing. It takes two
+  // decodes, since a move list that spills refills its inline moves on the next
+  pokepaste::PokePaste reused;
+  pokepaste::decode_pokepaste_into(text, reused);
+  pokepaste::decode_pokepaste_into(text, reused);
+  check_at_most("decode_pokepaste_into", name, 0, [&] {
+    pokepaste::decode_pokepaste_into(text, reused);
+  });
+  // Copies leave behind the move strings the reused Pokemon keep for later decodes
+  check_at_most("PokePaste copy", name, owned_allocations(paste), [&] {
+    const auto copy = reused;
+    (void)copy;
+  });
+
+  // Everything comes from the arena, which never falls back on the heap
+  std::vector<std::byte> arena_buffer((text.size() * 64) + 65536);
+  check_at_most("decode_pokepaste(memory_resource)", name, 0, [&] {
+    std::pmr::monotonic_buffer_resource arena{arena_buffer.data(), arena_buffer.size(), std::pmr::null_memory_resource()};
+    (void)pokepaste::decode_pokepaste(text, &arena);
+  });
+
+  const auto binary = pokepaste::encode_binary(paste);
+  check_at_most("decode_binary", name, owned_allocations(paste), [&] {
+    (void)pokepaste::decode_binary(binary);
+  });
+  check_at_most("decode_binary_into", name, 0, [&] {
+    pokepaste::decode_binary_into(binary, reused);
+  });
+
+  const auto packed = pokepaste::encode_packed(paste);
+  check_at_most("decode_packed", name, owned_allocations(paste), [&] {
+    (void)pokepaste::decode_packed(packed);
+  });
+  if (fits_view) {
+    check_at_most("decode_packed_view", name, growths(0, paste.size()), [&] {
+      (void)pokepaste::decode_packed_view(packed);
+    });
+  }
+  // A team fed whole is decoded straight from it, except the last Pokemon, which waits for finish()
+  check_at_most("PackedStreamDecoder", name, 1 + owned_allocations(paste) - growths(0, paste.size()), [&] {
+    pokepaste::PackedStreamDecoder decoder{[](pokepaste::Pokemon) {}};
+    decoder.feed(packed);
+    decoder.finish();
+  });
+  check_at_most("encode_packed", name, 1, [&] {
+    (void)pokepaste::encode_packed(paste);
+  });
+
+  // Encoding reserves the exact size up front
+  check_at_most("encode_pokepaste", name, 1, [&] {
+    (void)pokepaste::encode_pokepaste(paste);
+  });
+  check_at_most("encoded_size", name, 0, [&] {
+    (void)pokepaste::encoded_size(paste);
+  });
+  std::string buffer;
+  buffer.reserve(pokepaste::encoded_size(paste));
+  check_at_most("encode_pokepaste_to", name, 0, [&] {
+    pokepaste::encode_pokepaste_to(buffer, paste);
+  });
+
+  for (const auto &pokemon : paste) {
+    const auto pokemon_text = pokepaste::encode_pokemon(pokemon);
+    if (fits_view) {
+      check_at_most("decode_pokemon_view", name, 0, [&] {
+        (void)pokepaste::decode_pokemon_view(pokemon_text);
+      });
+    }
+    check_at_most("decode_pokemon", name, owned_allocations(pokemon), [&] {
+      (void)pokepaste::decode_pokemon(pokemon_text);
+    });
+    // All of a CompactPokemon's text shares one string
+    check_at_most("decode_pokemon_compact", name, 1 + move_list_allocations(pokemon.moves.size()), [&] {
+      (void)pokepaste::decode_pokemon_compact(pokemon_text);
+    });
+    check_at_most("encode_pokemon_to", name, 0, [&] {
+      std::array<char, 4096> out{};
+      (void)pokepaste::encode_pokemon_to(out.begin(), pokemon);
+    });
+
+    // Line decoders that return views or numbers never allocate
+    check_at_most("detail::decode_*_line", name, 0, [&] {
+      std::size_t begin = 0;
+      for (bool first = true; begin <= pokemon_text.size(); first = false) {
+        const auto end  = std::min(pokemon_text.find('\n', begin), pokemon_text.size());
+        const auto line = std::string_view{pokemon_text}.substr(begin, end - begin);
+        begin           = end + 1;
+        if (first) {
+          (void)pokepaste::detail::decode_name_line_view(line);
+          continue;
+        }
+        using pokepaste::FieldKind;
+        switch (pokepaste::detail::classify_line(line).value()) {
+        case FieldKind::Ability:
+          (void)pokepaste::detail::decode_ability_line_view(line);
+          break;
+        case FieldKind::Level:
+          (void)pokepaste::detail::decode_level_line(line);
+          break;
+        case FieldKind::Shiny:
+          (void)pokepaste::detail::decode_shiny_line(line);
+          break;
+        case FieldKind::Happiness:
+          (void)pokepaste::detail::decode_happiness_line(line);
+          break;
+        case FieldKind::DynamaxLevel:
+          (void)pokepaste::detail::decode_dynamax_level_line(line);
+          break;
+        case FieldKind::Gigantamax:
+          (void)pokepaste::detail::decode_gigantamax_line(line);
+          break;
+        case FieldKind::TeraType:
+          (void)pokepaste::detail::decode_tera_type_line_view(line);
+          break;
+        case FieldKind::EVs:
+          (void)pokepaste::detail::decode_evs_line(line);
+          break;
+        case FieldKind::Nature:
+          (void)pokepaste::detail::decode_nature_line_view(line);
+          break;
+        case FieldKind::IVs:
+          (void)pokepaste::detail::decode_ivs_line(line);
+          break;
+        case FieldKind::Move:
+          (void)pokepaste::detail::decode_move_line_view(line);
+          break;
+        default:
+          break;
+        }
+      }
+    });
+  }
+}
+
+} // namespace
+
+// NOLINTNEXTLINE(bugprone-exception-escape) doesnt really matter
+auto main() -> int {
+  std::size_t pastes = 0;
+  // The resource files as they are, with their own whitespace and line endings
+  for (const auto &[path, paste] : ngl::pokepaste::decode_pokepaste_directory("resources")) {
+    const ngl::pokepaste::detail::MappedFile file{path};
+    check_paste(path.filename().string(), file.view());
+    pastes++;
+  }
+
+  // Generated pastes cover what the resources don't, like long move lists and CRLF line endings
+  ngl::pokepaste::synthetic::Options options;
+  options.seed      = 1;
+  options.max_moves = 12;
+  options.crlf_rate = 0.5;
+  ngl::pokepaste::synthetic::Generator generator{options};
+  for (std::size_t i = 0; i < 200; i++) {
+    check_paste("generated paste " + std::to_string(i), generator.paste().text);
+    pastes++;
+  }
+
+  if ((pastes == 0) || (failures > 0)) {
+    std::cout << failures << " allocation bounds exceeded over " << pastes << " pastes\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
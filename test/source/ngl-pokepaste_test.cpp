@@ -1,16 +1,25 @@
 
+#include <array>
 #include <cassert>
 #include <cstring>
 #include <filesystem>
+#include <format>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <memory_resource>
 #include <optional>
 #include <source_location>
 #include <span>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include "ngl-pokepaste/file.hpp"
+#include "ngl-pokepaste/parallel.hpp"
 #include "ngl-pokepaste/pokepaste.hpp"
+#include "ngl-pokepaste/synthetic.hpp"
 
 static bool verbose = false; // NOLINT
 
@@ -35,6 +44,106 @@ std::ostream &operator<<(std::ostream &os, const std::optional<T> &data) {
   os << (data.has_value() ? data.value() : "std::nullopt");
   return os;
 }
+
+// The original std::format based encoder, which the current one must stay byte for byte identical to
+namespace golden {
+std::string encode_string_line(const std::string &line, const std::string &prefix) {
+  return std::format("{} {}", ngl::util::trim(prefix), ngl::util::trim(line));
+}
+
+std::string encode_number_line(int number, const std::string &prefix) {
+  return encode_string_line(std::to_string(number), prefix);
+}
+
+std::string encode_bool_line(bool value, const std::string &prefix) {
+  return encode_string_line(value ? "Yes" : "No", prefix);
+}
+
+std::string encode_stat_line(const ngl::pokepaste::Pokemon::Stats &stats, const std::string &prefix, const ngl::pokepaste::Pokemon::Stats &baseline = {}) {
+  std::vector<std::string> parts;
+  if (stats.hp != baseline.hp) {
+    parts.push_back(std::format("{} HP", std::to_string(stats.hp)));
+  }
+  if (stats.atk != baseline.atk) {
+    parts.push_back(std::format("{} Atk", std::to_string(stats.atk)));
+  }
+  if (stats.def != baseline.def) {
+    parts.push_back(std::format("{} Def", std::to_string(stats.def)));
+  }
+  if (stats.spatk != baseline.spatk) {
+    parts.push_back(std::format("{} SpA", std::to_string(stats.spatk)));
+  }
+  if (stats.spdef != baseline.spdef) {
+    parts.push_back(std::format("{} SpD", std::to_string(stats.spdef)));
+  }
+  if (stats.spd != baseline.spd) {
+    parts.push_back(std::format("{} Spe", std::to_string(stats.spd)));
+  }
+  return encode_string_line(ngl::util::join(parts, " / "), prefix);
+}
+
+std::string encode_name_line(const ngl::pokepaste::Pokemon &pokemon) {
+  std::string out;
+  if (pokemon.nickname.has_value()) {
+    out.append(std::format("{} ({})", pokemon.nickname.value(), pokemon.species));
+  } else {
+    out.append(pokemon.species);
+  }
+  if (pokemon.gender.has_value()) {
+    out.append(pokemon.gender.value() == ngl::pokepaste::Gender::M ? " (M)" : " (F)");
+  }
+  if (pokemon.item.has_value()) {
+    out.append(std::format(" @ {}", pokemon.item.value()));
+  }
+  return out;
+}
+
+std::string encode_pokemon(const ngl::pokepaste::Pokemon &pokemon) {
+  using ngl::pokepaste::Pokemon;
+  std::vector<std::string> parts;
+  parts.push_back(encode_name_line(pokemon));
+  parts.push_back(encode_string_line(pokemon.ability, "Ability:"));
+  if (pokemon.level.has_value()) {
+    parts.push_back(encode_number_line(static_cast<int>(pokemon.level.value()), "Level:"));
+  }
+  if (pokemon.shiny) {
+    parts.push_back(encode_bool_line(pokemon.shiny, "Shiny:"));
+  }
+  if (pokemon.happiness != Pokemon::DEFAULT_HAPPINESS) {
+    parts.push_back(encode_number_line(static_cast<int>(pokemon.happiness), "Happiness:"));
+  }
+  if (pokemon.dynamax_level != Pokemon::DEFAULT_DYNAMAX_LEVEL) {
+    parts.push_back(encode_number_line(static_cast<int>(pokemon.dynamax_level), "Dynamax Level:"));
+  }
+  if (pokemon.gigantamax) {
+    parts.push_back(encode_bool_line(pokemon.gigantamax, "Gigantamax:"));
+  }
+  if (pokemon.tera_type.has_value()) {
+    parts.push_back(encode_string_line(pokemon.tera_type.value(), "Tera Type:"));
+  }
+  if (pokemon.evs != Pokemon::Stats{0, 0, 0, 0, 0, 0}) {
+    parts.push_back(encode_stat_line(pokemon.evs, "EVs: "));
+  }
+  if (pokemon.nature.has_value()) {
+    parts.push_back(std::format("{} Nature", pokemon.nature.value()));
+  }
+  if (pokemon.ivs != Pokemon::DEFAULT_IVS) {
+    parts.push_back(encode_stat_line(pokemon.ivs, "IVs: ", Pokemon::DEFAULT_IVS));
+  }
+  for (const auto &move : pokemon.moves) {
+    parts.push_back(encode_string_line(move, "-"));
+  }
+  return ngl::util::join(parts, "\n");
+}
+
+std::string encode_pokepaste(const ngl::pokepaste::PokePaste &paste) {
+  std::string out;
+  for (const auto &pokemon : paste) {
+    out.append(std::format("{}\n\n", ngl::util::trim(golden::encode_pokemon(pokemon))));
+  }
+  return ngl::util::trim(out);
+}
+} // namespace golden
 } // namespace
 
 // NOLINTNEXTLINE(bugprone-exception-escape) doesnt really matter
@@ -133,10 +242,158 @@ auto main(int argc, const char **argv) -> int {
       const auto lower_expected = std::string{"abcdefg"};
       assert((lower_result == lower_expected));
     }
+
+    {
+      const auto trim_value  = std::string{" \t abc \r\n"};
+      const auto trim_result = ngl::util::trim_view(trim_value);
+      assert((trim_result == "abc"));
+      assert((trim_result.data() == trim_value.data() + 3));
+      assert((ngl::util::trim_view(" \t ").empty()));
+    }
+
+    {
+      assert((ngl::util::iequals("SpA", "spa")));
+      assert((!ngl::util::iequals("SpA", "spd")));
+      assert((!ngl::util::iequals("SpA", "sp")));
+    }
+
+    {
+      assert((ngl::util::to_int("252") == 252));
+      assert((ngl::util::to_int(" +4") == 4));
+      assert((ngl::util::to_int("-1") == -1));
+      try {
+        (void)ngl::util::to_int("HP");
+        assert(false);
+      } catch ([[maybe_unused]] const std::invalid_argument &e) { // NOLINT
+      }
+      try {
+        (void)ngl::util::to_int("99999999999");
+        assert(false);
+      } catch ([[maybe_unused]] const std::out_of_range &e) { // NOLINT
+      }
+    }
+
+    {
+      ngl::util::SmallVector<std::string, 4> small{"a", "b"};
+      small.emplace_back(std::string_view{"c"});
+      small.push_back("d");
+      assert((small.inlined() && small.size() == 4));
+      const auto *const inline_data = small.data();
+      small.push_back("e");
+      assert((!small.inlined() && small.data() != inline_data));
+      const auto *const heap_data = small.data();
+      assert((std::vector<std::string>(small.begin(), small.end()) == std::vector<std::string>{"a", "b", "c", "d", "e"}));
+      assert((small == ngl::util::SmallVector<std::string, 4>{std::vector<std::string>{"a", "b", "c", "d", "e"}}));
+      assert((small > ngl::util::SmallVector<std::string, 4>{"a", "b", "c", "d"}));
+
+      small.clear();
+      assert((small.empty() && small.inlined()));
+      small.push_back("f");
+      assert((small.data() == inline_data && small.front() == "f" && small.back() == "f"));
+      // Spilling again reuses the heap elements clear() kept
+      for (const auto *const value : {"g", "h", "i", "j"}) {
+        small.push_back(value);
+      }
+      assert((!small.inlined() && small.data() == heap_data));
+      assert((std::vector<std::string>(small.begin(), small.end()) == std::vector<std::string>{"f", "g", "h", "i", "j"}));
+
+      // Copies take only the current elements, not the ones kept for reuse
+      small.clear();
+      small.push_back("k");
+      const auto copy = small;
+      assert((copy.inlined() && copy.capacity() == 4 && copy == std::vector<std::string>{"k"}));
+      auto assigned = ngl::util::SmallVector<std::string, 4>{"a", "b", "c", "d", "e"};
+      assigned      = small;
+      assert((assigned == std::vector<std::string>{"k"}));
+      for (const auto *const value : {"g", "h", "i", "j"}) {
+        small.push_back(value);
+      }
+      auto moved = std::move(small);
+      assert((moved.size() == 5 && small.empty() && small.inlined())); // NOLINT(bugprone-use-after-move)
+    }
+
+    {
+      // The std::vector members code editing a Pokemon's moves relies on
+      ngl::util::SmallVector<std::string, 4> moves{"a", "b", "c"};
+      moves.erase(moves.begin() + 1);
+      assert((moves == std::vector<std::string>{"a", "c"}));
+      assert((*moves.insert(moves.begin() + 1, "b") == "b"));
+      moves.insert(moves.end(), "d");
+      moves.insert(moves.begin(), "z");
+      assert((!moves.inlined() && moves == std::vector<std::string>{"z", "a", "b", "c", "d"}));
+      moves.erase(moves.begin(), moves.begin() + 2);
+      moves.pop_back();
+      assert((moves == std::vector<std::string>{"b", "c"}));
+      moves.resize(4, "x");
+      assert((moves == std::vector<std::string>{"b", "c", "x", "x"}));
+      moves.resize(1);
+      assert((moves.at(0) == "b"));
+      try {
+        (void)moves.at(1);
+        assert(false);
+      } catch ([[maybe_unused]] const std::out_of_range &e) { // NOLINT
+      }
+      const std::vector<std::string> converted = moves;
+      assert((converted == std::vector<std::string>{"b"}));
+    }
+
+    {
+      // Growing from one of its own elements copies the element, as std::vector does, even when
+      // that growth moves the elements to the heap
+      ngl::pokepaste::Pokemon pokemon;
+      pokemon.moves = {"Tackle", "Growl", "Ember", "Swift"};
+      pokemon.moves.push_back(pokemon.moves.front());
+      assert((pokemon.moves == std::vector<std::string>{"Tackle", "Growl", "Ember", "Swift", "Tackle"}));
+      pokemon.moves.push_back(pokemon.moves.back());
+      assert((pokemon.moves.size() == 6 && pokemon.moves.back() == "Tackle"));
+
+      // Including when clear() left heap elements for the spill to swap in
+      const std::vector<std::string> full{"Tackle", "Growl", "Ember", "Swift"};
+      pokemon.moves.clear();
+      pokemon.moves.assign(full.begin(), full.end());
+      pokemon.moves.emplace_back(pokemon.moves[1]);
+      assert((pokemon.moves == std::vector<std::string>{"Tackle", "Growl", "Ember", "Swift", "Growl"}));
+      pokemon.moves.assign(full.begin(), full.begin() + 2);
+      pokemon.moves.resize(12, pokemon.moves.front());
+      assert((pokemon.moves.size() == 12 && pokemon.moves.back() == "Tackle"));
+    }
   }
 
   // ngl::pokepaste::detail
   {
+    {
+      // Every scanner must split lines exactly like a plain search for '\n', whatever the alignment
+      std::string lines_value;
+      for (std::size_t i = 0; i < 300; i++) {
+        lines_value.append(i % 7, 'x');
+        lines_value.append((i % 5 == 0) ? "\r\n" : "\n");
+      }
+      for (const auto scanner : {ngl::pokepaste::LineScanner::Scalar, ngl::pokepaste::LineScanner::SSE2, ngl::pokepaste::LineScanner::AVX2}) {
+        if (!ngl::pokepaste::line_scanner_supported(scanner)) {
+          continue;
+        }
+        ngl::pokepaste::set_line_scanner(scanner);
+        assert((ngl::pokepaste::active_line_scanner() == scanner));
+        for (std::size_t offset = 0; offset < 40; offset++) {
+          const auto lines_data = std::string_view{lines_value}.substr(offset);
+          ngl::pokepaste::detail::LineReader reader{lines_data};
+          std::size_t position = 0;
+          while (const auto line = reader.next()) {
+            const auto end = lines_data.find('\n', position);
+            auto expected  = lines_data.substr(position, end - position);
+            if (ngl::util::ends_with(expected, "\r")) {
+              expected.remove_suffix(1);
+            }
+            assert((line.value() == expected));
+            assert((line->data() == lines_data.data() + position));
+            position = (end == std::string_view::npos) ? lines_data.size() + 1 : end + 1;
+          }
+          assert((position == lines_data.size() + 1));
+        }
+      }
+      ngl::pokepaste::set_line_scanner(ngl::pokepaste::LineScanner::Auto);
+    }
+
     {
       const auto name_value    = std::string{"Species"};
       const auto name_result   = ngl::pokepaste::detail::decode_name_line(name_value);
@@ -222,6 +479,54 @@ auto main(int argc, const char **argv) -> int {
       CHECK_EQ(name_result.item, name_expected.item);
     }
 
+    {
+      const auto name_value    = std::string{"Mr. (Mime) (Mr. Mime-Galar) (F)"};
+      const auto name_result   = ngl::pokepaste::detail::decode_name_line(name_value);
+      const auto name_expected = ngl::pokepaste::detail::SpeciesLineInfo{
+        "Mr.", "Mime) (Mr. Mime-Galar", ngl::pokepaste::Gender::F, std::nullopt
+      };
+      CHECK_EQ(name_result, name_expected);
+    }
+
+    {
+      // A male gender and item marker pair takes precedence over a female one wherever they are
+      const auto name_value    = std::string{" (M) (Species) (M) @ Item (F) @ Other Item"};
+      const auto name_result   = ngl::pokepaste::detail::decode_name_line(name_value);
+      const auto name_expected = ngl::pokepaste::detail::SpeciesLineInfo{
+        "(M)", "Species", ngl::pokepaste::Gender::M, "Item (F) @ Other Item"
+      };
+      CHECK_EQ(name_result, name_expected);
+    }
+
+    {
+      // A male gender and item marker inside the nickname is kept as it was written. The split based
+      // parser rejoined the parts before the last one with the female marker, giving "Guy(F) @ Home"
+      const auto name_value    = std::string{"Guy(M) @ Home (Pikachu) (M) @ Light Ball"};
+      const auto name_result   = ngl::pokepaste::detail::decode_name_line(name_value);
+      const auto name_expected = ngl::pokepaste::detail::SpeciesLineInfo{
+        "Guy(M) @ Home", "Pikachu", ngl::pokepaste::Gender::M, "Light Ball"
+      };
+      CHECK_EQ(name_result, name_expected);
+    }
+
+    {
+      // Overlapping item markers are cut the way splitting left to right would cut them
+      const auto name_value    = std::string{"Nickname (Species) @ @ Item"};
+      const auto name_result   = ngl::pokepaste::detail::decode_name_line(name_value);
+      const auto name_expected = ngl::pokepaste::detail::SpeciesLineInfo{
+        "Nickname", "Species", std::nullopt, "@ Item"
+      };
+      CHECK_EQ(name_result, name_expected);
+    }
+
+    {
+      try {
+        (void)ngl::pokepaste::detail::decode_name_line("Nickname (Species) x");
+        assert(false);
+      } catch ([[maybe_unused]] const std::runtime_error &e) { // NOLINT
+      }
+    }
+
     {
       const auto ability_value = std::string{"dummy ability"};
       const auto ability       = ngl::pokepaste::detail::decode_ability_line(
@@ -415,6 +720,53 @@ auto main(int argc, const char **argv) -> int {
       }
     }
 
+    {
+      using ngl::pokepaste::FieldKind;
+      using ngl::pokepaste::detail::classify_line;
+      static_assert(classify_line("Ability: Levitate") == FieldKind::Ability);
+      static_assert(classify_line("Dynamax Level: 3") == FieldKind::DynamaxLevel);
+      static_assert(classify_line("Tera Type: Fairy") == FieldKind::TeraType);
+      static_assert(classify_line("Jolly Nature") == FieldKind::Nature);
+      static_assert(classify_line("- Protect") == FieldKind::Move);
+      static_assert(classify_line("IVs: 0 Atk") == FieldKind::IVs);
+      // Prefixed fields win over a trailing "Nature", which wins over IVs and moves
+      static_assert(classify_line("Ability: Nature") == FieldKind::Ability);
+      static_assert(classify_line("IVs: Nature") == FieldKind::Nature);
+      static_assert(classify_line("- Nature") == FieldKind::Nature);
+      static_assert(!classify_line("Abilities: Levitate").has_value());
+      static_assert(!classify_line("Level 50").has_value());
+    }
+
+    {
+      static_assert(ngl::pokepaste::detail::stat_index("hP") == 0);
+      static_assert(ngl::pokepaste::detail::stat_index("SPE") == 5);
+      static_assert(!ngl::pokepaste::detail::stat_index("Sp").has_value());
+      static_assert(!ngl::pokepaste::detail::stat_index("HP ").has_value());
+      const auto ev_result   = ngl::pokepaste::detail::decode_evs_line("EVs: 4 hp / 252 ATK / 252 spe");
+      const auto ev_expected = ngl::pokepaste::Pokemon::Stats{4, 252, 0, 0, 0, 252};
+      assert((ev_result == ev_expected));
+    }
+
+    {
+      const auto stat_errors = std::vector<std::pair<std::string, std::string>>{
+        {"EVs: ", "Pokemon stat line must contain at least one value"},
+        {"EVs: 1 HP / 1 Atk / 1 Def / 1 SpA / 1 SpD / 1 Spe / 1 HP", "Pokemon may not specify more than 6 stat values"},
+        {"EVs: 1 HP / / 1 Atk", "Stat entry data is malformed"},
+        {"EVs: 1  HP", "Stat entry data is malformed"},
+        {"EVs: -4 HP", "Stat value cannot be less than 0"},
+        {"EVs: 4 Speed", "Invalid stat name"},
+        {"EVs: 4 SpA / 4 spa", "Pokemon may not specify multiple values for a single stat"}
+      };
+      for (const auto &[ev_value, ev_error] : stat_errors) {
+        try {
+          (void)ngl::pokepaste::detail::decode_evs_line(ev_value);
+          assert(false);
+        } catch (const std::runtime_error &e) {
+          assert((e.what() == ev_error));
+        }
+      }
+    }
+
     {
       const auto nature_value = std::string{"dummy nature"};
       const auto nature       = ngl::pokepaste::detail::decode_nature_line(
@@ -762,6 +1114,690 @@ auto main(int argc, const char **argv) -> int {
 
       CHECK_EQ(paste_result, paste_expected);
     }
+
+    {
+      const auto paste_value = std::string{
+        "Nickname (Species) (F) @ Item\r\n"
+        "Ability: Ability\r\n"
+        "- Attack 1\r\n"
+        "\r\n"
+        "   \r\n"
+        "\r\n"
+        "  Species  \r\n"
+        "Ability: Ability\r\n"
+        "  \r\n"
+      };
+
+      const auto paste_result   = ngl::pokepaste::decode_pokepaste(std::string_view{paste_value});
+      const auto paste_expected = ngl::pokepaste::decode_pokepaste(
+        "Nickname (Species) (F) @ Item\n"
+        "Ability: Ability\n"
+        "- Attack 1\n"
+        "\n"
+        "Species\n"
+        "Ability: Ability"
+      );
+      assert((paste_result.size() == 2));
+      assert((paste_result.front().gender == ngl::pokepaste::Gender::F));
+      assert((paste_result.back().species == "Species"));
+      CHECK_EQ(paste_result, paste_expected);
+    }
+
+    {
+      const auto paste_value = std::string{
+        "Nickname (Species) (M) @ Item\n"
+        "Ability: Ability\n"
+        "EVs: 252 Atk / 4 SpD / 252 Spe\n"
+        "Jolly Nature\n"
+        "- Attack 1\n"
+        "- Attack 2\n"
+        "\n"
+        "Species\n"
+        "Ability: Ability\n"
+      };
+
+      const auto view_result = ngl::pokepaste::decode_pokepaste_view(paste_value);
+      assert((view_result.size() == 2));
+      const auto &first = view_result.front();
+      assert((first.nickname == "Nickname"));
+      assert((first.item.has_value() && first.item->data() == paste_value.data() + paste_value.find("Item")));
+      assert((first.nature == "Jolly"));
+      assert((first.move_count == 2));
+      assert((first.move_list().back() == "Attack 2"));
+      CHECK_EQ(ngl::pokepaste::to_owned(view_result), ngl::pokepaste::decode_pokepaste(paste_value));
+
+      // Moves past move_count don't take part in comparisons
+      auto stale         = first;
+      stale.moves.back() = "Attack 4";
+      assert((stale == first));
+      assert(((stale <=> first) == 0));
+      stale.move_count--;
+      assert((stale != first));
+      assert((stale < first));
+    }
+
+    {
+      const auto pokemon_value = std::string{
+        "Species\n"
+        "Ability: Ability\n"
+        "- Attack 1\n"
+        "- Attack 2\n"
+        "- Attack 3\n"
+        "- Attack 4\n"
+        "- Attack 5\n"
+      };
+
+      assert((ngl::pokepaste::decode_pokemon(pokemon_value).moves.size() == 5));
+      try {
+        (void)ngl::pokepaste::decode_pokemon_view(pokemon_value);
+        assert(false);
+      } catch ([[maybe_unused]] const ngl::pokepaste::domain_bound_error &e) { // NOLINT
+      }
+    }
+
+    {
+      const auto paste_value = std::string{
+        "Nickname (Species) @ Item\n"
+        "Ability: Ability\n"
+        "- Attack 1\n"
+        "- Attack 2\n"
+        "\n"
+        "Species\n"
+        "Ability: Ability\n"
+        "Tera Type: Item\n"
+        "- Attack 2\n"
+      };
+
+      ngl::pokepaste::SymbolTable symbols;
+      const auto interned = ngl::pokepaste::decode_pokepaste_interned(paste_value, symbols);
+      assert((interned.size() == 2));
+      assert((symbols.size() == 6));
+      assert((interned[0].species == interned[1].species));
+      assert((interned[0].ability == interned[1].ability));
+      assert((interned[0].item == interned[1].tera_type));
+      assert((interned[0].moves[1] == interned[1].moves[0]));
+      assert((symbols.text(interned[0].moves[0]) == "Attack 1"));
+      assert((symbols.find("Attack 2") == interned[1].moves[0]));
+      assert((!symbols.find("Attack 3").has_value()));
+      CHECK_EQ(ngl::pokepaste::to_owned(interned, symbols), ngl::pokepaste::decode_pokepaste(paste_value));
+
+      const auto pokemon = ngl::pokepaste::decode_pokemon(paste_value.substr(0, paste_value.find("\n\n")));
+      assert((ngl::pokepaste::intern(pokemon, symbols) == interned[0]));
+      assert((symbols.size() == 6));
+
+      try {
+        (void)symbols.text(ngl::pokepaste::Symbol{6});
+        assert(false);
+      } catch ([[maybe_unused]] const ngl::pokepaste::domain_bound_error &e) {
+      }
+    }
+
+    {
+      static_assert(sizeof(ngl::pokepaste::CompactPokemon) * 4 < sizeof(ngl::pokepaste::Pokemon));
+
+      auto pokemon          = ngl::pokepaste::Pokemon{};
+      pokemon.nickname      = "";
+      pokemon.species       = "Species";
+      pokemon.gender        = ngl::pokepaste::Gender::F;
+      pokemon.ability       = "Ability";
+      pokemon.level         = 50;
+      pokemon.gigantamax    = true;
+      pokemon.dynamax_level = 0;
+      pokemon.nature        = "Jolly";
+      pokemon.evs           = {252, 0, 0, 0, 4, 252};
+      pokemon.ivs.atk       = 0;
+      pokemon.moves         = {"Attack 1", "", "Attack 3"};
+
+      const auto compact = ngl::pokepaste::CompactPokemon{pokemon};
+      assert((compact.nickname() == ""));
+      assert((!compact.item().has_value()));
+      assert((compact.gender() == ngl::pokepaste::Gender::F));
+      assert((compact.level() == 50));
+      assert((!compact.shiny() && compact.gigantamax()));
+      assert((compact.move_count() == 3));
+      assert((compact.move(1).empty() && compact.move(2) == "Attack 3"));
+      CHECK_EQ(compact.to_owned(), pokemon);
+      CHECK_EQ(ngl::pokepaste::encode_pokemon(compact), ngl::pokepaste::encode_pokemon(pokemon));
+
+      std::array<char, 256> buffer{};
+      const auto *const buffer_end = ngl::pokepaste::encode_pokemon_to(buffer.data(), pokemon);
+      CHECK_EQ(std::string_view(buffer.data(), buffer_end), ngl::pokepaste::encode_pokemon(pokemon));
+
+      // Appending trims each Pokemon and the whole paste like encode_pokepaste, but not what was already there
+      auto padded     = pokemon;
+      padded.nickname = " \n";
+      padded.ability  = "";
+      std::string appended{"prefix \n"};
+      ngl::pokepaste::encode_pokepaste_to(appended, {padded, ngl::pokepaste::Pokemon{}, pokemon});
+      CHECK_EQ(appended, "prefix \n" + ngl::pokepaste::encode_pokepaste({padded, ngl::pokepaste::Pokemon{}, pokemon}));
+      assert((appended.back() != ' ' && appended[9] != ' '));
+
+      const auto padded_paste = ngl::pokepaste::PokePaste{ngl::pokepaste::Pokemon{}, padded, ngl::pokepaste::Pokemon{}, pokemon, ngl::pokepaste::Pokemon{}};
+      assert((ngl::pokepaste::encoded_size(padded) == ngl::pokepaste::encode_pokemon(padded).size()));
+      assert((ngl::pokepaste::encoded_size(padded_paste) == ngl::pokepaste::encode_pokepaste(padded_paste).size()));
+      assert((ngl::pokepaste::encoded_size(ngl::pokepaste::PokePaste{}) == 0));
+      assert((ngl::pokepaste::encoded_size(compact) == ngl::pokepaste::encoded_size(pokemon)));
+
+      // Numbers at the edges of what the encoder handles, against the original encoder
+      auto numeric      = pokemon;
+      numeric.level     = std::numeric_limits<int>::max();
+      numeric.shiny     = true;
+      numeric.happiness = 0;
+      numeric.evs       = {0, 1, 9, 10, 99999, 1000000};
+      numeric.ivs       = {0, 31, 100, 31, 2147483647, 7};
+      numeric.tera_type = " Fairy ";
+      numeric.moves     = {" Move "};
+      CHECK_EQ(ngl::pokepaste::encode_pokemon(numeric), golden::encode_pokemon(numeric));
+      CHECK_EQ(ngl::pokepaste::encode_pokemon(padded), golden::encode_pokemon(padded));
+      CHECK_EQ(ngl::pokepaste::encode_pokepaste(padded_paste), golden::encode_pokepaste(padded_paste));
+      assert((ngl::pokepaste::CompactPokemon{ngl::pokepaste::Pokemon{}}.to_owned() == ngl::pokepaste::Pokemon{}));
+      assert((ngl::pokepaste::CompactPokemon{} == ngl::pokepaste::CompactPokemon{ngl::pokepaste::Pokemon{}}));
+
+      pokemon.evs.spd = 65536;
+      try {
+        (void)ngl::pokepaste::CompactPokemon{pokemon};
+        assert(false);
+      } catch ([[maybe_unused]] const ngl::pokepaste::domain_bound_error &e) {
+      }
+      pokemon.evs.spd = 252;
+      pokemon.moves.emplace_back("Attack\n4");
+      try {
+        (void)ngl::pokepaste::CompactPokemon{pokemon};
+        assert(false);
+      } catch ([[maybe_unused]] const ngl::pokepaste::domain_bound_error &e) {
+      }
+    }
+
+    {
+      using ngl::pokepaste::DecodeErrc;
+      using ngl::pokepaste::FieldKind;
+
+      const auto paste_value = std::string{
+        "Species\n"
+        "Ability: Ability\n"
+        "\n"
+        "Nickname (Species)\r\n"
+        "Ability: Ability\r\n"
+        "  EVs: 252 Atk / 4 Foo\r\n"
+      };
+      const auto result = ngl::pokepaste::try_decode_pokepaste(paste_value);
+      assert((!result.ok() && result.value.empty()));
+      assert((result.error->code == DecodeErrc::UnknownStat));
+      assert((result.error->line == 6 && result.error->column == 20));
+      assert((result.error->field == FieldKind::EVs));
+      try {
+        (void)ngl::pokepaste::decode_pokepaste(paste_value);
+        assert(false);
+      } catch (const std::runtime_error &e) {
+        assert((result.error->message() == e.what()));
+      }
+
+      const auto valid = ngl::pokepaste::try_decode_pokepaste(paste_value.substr(0, paste_value.find("  EVs")));
+      assert((valid.ok() && valid.value.size() == 2));
+
+      // Each error keeps the exception type the throwing API has always used
+      const auto number_result = ngl::pokepaste::try_decode_pokemon("Species\nAbility: Ability\nLevel: 99999999999");
+      assert((number_result.error->code == DecodeErrc::IntegerOutOfRange));
+      assert((number_result.error->line == 3 && number_result.error->column == 8));
+      try {
+        (void)ngl::pokepaste::decode_pokemon("Species\nAbility: Ability\nLevel: 99999999999");
+        assert(false);
+      } catch ([[maybe_unused]] const std::out_of_range &e) {
+      }
+
+      const auto structure_cases = std::vector<std::pair<std::string, ngl::pokepaste::DecodeError>>{
+        {"Species", {DecodeErrc::NotEnoughLines, 1, 1, std::nullopt}},
+        {"\n  Species\nLevel: 5", {DecodeErrc::MissingAbility, 2, 3, FieldKind::Ability}},
+        {"Species\nAbility: A\nAbility: B", {DecodeErrc::DuplicateLine, 3, 1, FieldKind::Ability}},
+        {"Species\nAbility: A\nWhat", {DecodeErrc::UnknownLine, 3, 1, std::nullopt}},
+        {"Species\nAbility: A\n\nOther\nAbility: A", {DecodeErrc::UnknownLine, 4, 1, std::nullopt}},
+        {"Nick (Species) x\nAbility: A", {DecodeErrc::MalformedName, 1, 1, FieldKind::Name}},
+        {"Species\nAbility: A\n- ", {DecodeErrc::EmptyMove, 3, 2, FieldKind::Move}},
+        {"", {DecodeErrc::NotEnoughLines, 1, 1, std::nullopt}},
+      };
+      for (const auto &[pokemon_value, expected] : structure_cases) {
+        const auto pokemon_result = ngl::pokepaste::try_decode_pokemon(pokemon_value);
+        assert((pokemon_result.error == expected));
+        assert((pokemon_result.value == ngl::pokepaste::Pokemon{}));
+      }
+    }
+
+    {
+      using ngl::pokepaste::DecodeErrc;
+      using ngl::pokepaste::FieldKind;
+
+      const auto paste_value = std::string{
+        "Nick (Species) x\n"
+        "Ability: A\n"
+        "- Bad Block\n"
+        "\n"
+        "First\n"
+        "Ability: A\n"
+        "\n"
+        "Second\n"
+        "Ability: A\n"
+        "Level: 0\n"
+        "- Bad Block\n"
+        "\n"
+        "Third\n"
+        "Level: 5\n"
+        "\n"
+        "Fourth\n"
+        "Ability: B\n"
+        "\n"
+        "Fifth\n"
+      };
+      const auto result = ngl::pokepaste::decode_pokepaste_recovering(paste_value);
+      assert((!result.ok()));
+      assert((result.pokemon.size() == 2));
+      CHECK_EQ(result.pokemon[0].species, "First");
+      CHECK_EQ(result.pokemon[1].species, "Fourth");
+      CHECK_EQ(result.pokemon[1].ability, "B");
+
+      const auto expected = std::vector<ngl::pokepaste::BlockDecodeError>{
+        {0, {DecodeErrc::MalformedName, 1, 1, FieldKind::Name}},
+        {2, {DecodeErrc::LevelTooLow, 10, 8, FieldKind::Level}},
+        {3, {DecodeErrc::MissingAbility, 13, 1, FieldKind::Ability}},
+        {5, {DecodeErrc::NotEnoughLines, 19, 1, std::nullopt}},
+      };
+      assert((result.errors == expected));
+
+      const auto valid = ngl::pokepaste::decode_pokepaste_recovering("\n\nFirst\nAbility: A\n\n\n\nSecond\nAbility: A\n\n");
+      assert((valid.ok()));
+      CHECK_EQ(valid.pokemon, ngl::pokepaste::decode_pokepaste("First\nAbility: A\n\nSecond\nAbility: A"));
+      assert((ngl::pokepaste::decode_pokepaste_recovering("").ok()));
+    }
+
+    {
+      using ngl::pokepaste::DecodePhase;
+      using ngl::pokepaste::FieldKind;
+
+      const auto paste_value = std::string{
+        "Nickname (Species) @ Item\n"
+        "Ability: Ability\n"
+        "Level: 50\n"
+        "EVs: 252 HP / 4 Atk\n"
+        "IVs: 0 Atk\n"
+        "- Move\n"
+        "- A Move Too Long To Be Stored Inline\n"
+        "\n"
+        "Species\n"
+        "Ability: Ability"
+      };
+      const auto invalid_value = std::string{"Species\nAbility: Ability\nUnknown"};
+
+      const auto before = ngl::pokepaste::thread_decode_counters();
+      (void)ngl::pokepaste::decode_pokepaste(paste_value);
+      try {
+        (void)ngl::pokepaste::decode_pokemon(invalid_value);
+        assert(false);
+      } catch ([[maybe_unused]] const std::runtime_error &e) {
+      }
+      const auto counters = ngl::pokepaste::thread_decode_counters() - before;
+
+      // Other threads' counters only reach this one's through the total
+      const auto total_before = ngl::pokepaste::total_decode_counters();
+      std::thread{[&] {
+        (void)ngl::pokepaste::decode_pokepaste(paste_value);
+      }}.join();
+      const auto thread_counters = ngl::pokepaste::total_decode_counters() - total_before;
+
+      if constexpr (ngl::pokepaste::DECODE_INSTRUMENTED) {
+        CHECK_EQ(counters.lines_of(FieldKind::Name), 3);
+        CHECK_EQ(counters.lines_of(FieldKind::Ability), 3);
+        CHECK_EQ(counters.lines_of(FieldKind::Level), 1);
+        CHECK_EQ(counters.lines_of(FieldKind::EVs), 1);
+        CHECK_EQ(counters.lines_of(FieldKind::IVs), 1);
+        CHECK_EQ(counters.lines_of(FieldKind::Move), 2);
+        CHECK_EQ(counters.lines_of(FieldKind::Nature), 0);
+        CHECK_EQ(counters.unknown_lines, 1);
+        CHECK_EQ(counters.bytes_scanned, paste_value.size() + invalid_value.size());
+        CHECK_EQ(counters.exceptions, 1);
+        // The paste vector growing twice and the long move; every other string fits inline
+        CHECK_EQ(counters.estimated_allocations, 3);
+        assert((counters.time_in(DecodePhase::Split).count() > 0));
+        assert((counters.time_in(DecodePhase::NameLine).count() > 0));
+        assert((counters.time_in(DecodePhase::Stats).count() > 0));
+        assert((counters.time_in(DecodePhase::Dispatch) >= counters.time_in(DecodePhase::Stats)));
+        CHECK_EQ(thread_counters.lines_of(FieldKind::Name), 2);
+        CHECK_EQ(thread_counters.bytes_scanned, paste_value.size());
+      } else {
+        assert((counters == ngl::pokepaste::DecodeCounters{}));
+        assert((thread_counters == ngl::pokepaste::DecodeCounters{}));
+      }
+      auto sum = counters;
+      sum += thread_counters;
+      assert((sum - thread_counters == counters));
+    }
+
+    {
+      const auto paste_value = std::string{
+        "A Nickname Too Long To Be Stored Inline (Species) @ An Item Too Long To Be Stored Inline\n"
+        "Ability: An Ability Too Long To Be Stored Inline\n"
+        "Tera Type: A Tera Type Too Long To Be Stored Inline\n"
+        "- A Move Too Long To Be Stored Inline\n"
+        "\n"
+        "Species\n"
+        "Ability: Ability\n"
+        "Level: 50\n"
+        "Adamant Nature"
+      };
+      ngl::pokepaste::PokePaste paste;
+      ngl::pokepaste::decode_pokepaste_into(paste_value, paste);
+      CHECK_EQ(paste, ngl::pokepaste::decode_pokepaste(paste_value));
+      const auto *const paste_data   = paste.data();
+      const auto *const ability_data = paste[0].ability.data();
+      const auto *const move_data    = paste[0].moves[0].data();
+      ngl::pokepaste::decode_pokepaste_into(paste_value, paste);
+      CHECK_EQ(paste, ngl::pokepaste::decode_pokepaste(paste_value));
+      assert((paste.data() == paste_data));
+      assert((paste[0].ability.data() == ability_data));
+      assert((paste[0].moves[0].data() == move_data));
+
+      // Fields the new Pokemon doesn't set go back to their defaults
+      ngl::pokepaste::decode_pokemon_into("Other\nAbility: Other", paste[0]);
+      CHECK_EQ(paste[0], ngl::pokepaste::decode_pokemon("Other\nAbility: Other"));
+      ngl::pokepaste::decode_pokepaste_into("Other\nAbility: Other", paste);
+      CHECK_EQ(paste, ngl::pokepaste::decode_pokepaste("Other\nAbility: Other"));
+      ngl::pokepaste::decode_pokepaste_into("", paste);
+      assert((paste.empty()));
+    }
+
+    {
+      const auto pokemon_value = std::string{
+        "A Nickname Too Long To Be Stored Inline (Species) (F) @ An Item Too Long To Be Stored Inline\n"
+        "Ability: An Ability Too Long To Be Stored Inline\n"
+        "Tera Type: A Tera Type Too Long To Be Stored Inline\n"
+        "A Nature Too Long To Be Stored Inline Nature\n"
+        "- A Move Too Long To Be Stored Inline\n"
+        "- Move"
+      };
+      std::pmr::monotonic_buffer_resource arena;
+      auto *const previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+      const auto pokemon   = ngl::pokepaste::decode_pokemon(pokemon_value, &arena);
+      std::pmr::set_default_resource(previous);
+      CHECK_EQ(ngl::pokepaste::encode_pokemon(pokemon), pokemon_value);
+      assert((pokemon.nickname->get_allocator().resource() == &arena));
+      assert((pokemon.moves.front().get_allocator().resource() == &arena));
+
+      // Copies into another resource take nothing from the original's
+      std::pmr::monotonic_buffer_resource other_arena;
+      const ngl::pokepaste::pmr::Pokemon copy{pokemon, &other_arena};
+      assert((copy == pokemon));
+      assert((copy.item->get_allocator().resource() == &other_arena));
+      assert((copy.moves.front().get_allocator().resource() == &other_arena));
+
+      try {
+        (void)ngl::pokepaste::decode_pokepaste("Species\nAbility: A\n\nSpecies\nLevel: 0", &arena);
+        assert(false);
+      } catch (const std::runtime_error &e) {
+        CHECK_EQ(std::string_view{e.what()}, "Pokemon Level cannot be less than 0");
+      }
+    }
+
+    {
+      // The binary form keeps every field, including an empty item the text form has no line for
+      ngl::pokepaste::Pokemon pokemon;
+      pokemon.nickname      = "Nickname";
+      pokemon.species       = "Species";
+      pokemon.gender        = ngl::pokepaste::Gender::F;
+      pokemon.item          = "";
+      pokemon.ability       = "Ability";
+      pokemon.level         = 1;
+      pokemon.shiny         = true;
+      pokemon.happiness     = 1;
+      pokemon.dynamax_level = std::numeric_limits<int>::max();
+      pokemon.gigantamax    = true;
+      pokemon.tera_type     = "Ability";
+      pokemon.evs           = {252, 0, 4, 0, 0, 252};
+      pokemon.nature        = "Nature";
+      pokemon.ivs           = {31, 0, 31, 31, 31, 0};
+      pokemon.moves         = {"Protect", "Move", "Protect", "Move", "Protect"};
+      const auto binary     = ngl::pokepaste::encode_binary(pokemon);
+      CHECK_EQ(ngl::pokepaste::decode_binary_pokemon(binary), pokemon);
+      CHECK_EQ(ngl::pokepaste::decode_binary(binary), ngl::pokepaste::PokePaste{pokemon});
+
+      const auto repeated = ngl::pokepaste::encode_binary(ngl::pokepaste::PokePaste{pokemon, pokemon, pokemon});
+      CHECK_EQ(ngl::pokepaste::decode_binary(repeated), (ngl::pokepaste::PokePaste{pokemon, pokemon, pokemon}));
+      std::string appended{"prefix"};
+      ngl::pokepaste::encode_binary_to(appended, ngl::pokepaste::PokePaste{pokemon, pokemon, pokemon});
+      CHECK_EQ(appended, "prefix" + repeated);
+
+      ngl::pokepaste::Pokemon defaults;
+      defaults.species = "Species";
+      defaults.ability = "Ability";
+      CHECK_EQ(ngl::pokepaste::decode_binary_pokemon(ngl::pokepaste::encode_binary(defaults)), defaults);
+      assert((ngl::pokepaste::decode_binary(ngl::pokepaste::encode_binary(ngl::pokepaste::PokePaste{})).empty()));
+
+      const auto binary_error = [](std::string_view data) {
+        try {
+          (void)ngl::pokepaste::decode_binary(data);
+        } catch (const std::runtime_error &e) {
+          return std::string{e.what()};
+        }
+        return std::string{};
+      };
+      for (std::size_t size = 0; size < binary.size(); size++) {
+        assert((!binary_error(std::string_view{binary}.substr(0, size)).empty()));
+      }
+      CHECK_EQ(binary_error(binary + '\0'), "Binary PokePaste has trailing data");
+      CHECK_EQ(binary_error("NGLQ\x01\0\0"), "Data is not a binary PokePaste");
+      CHECK_EQ(binary_error("NGLP\x02\0\0"), "Binary PokePaste version 2 is not supported");
+      CHECK_EQ(binary_error("NGLP\x01\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\xFF\x02"), "Binary PokePaste varint is out of range");
+      CHECK_EQ(binary_error("NGLP\x01\x7F"), "Binary PokePaste is truncated");
+      CHECK_EQ(binary_error(std::string{"NGLP\x01\x01\0\x05", 8}), "Binary PokePaste is truncated");
+      CHECK_EQ(binary_error(std::string{"NGLP\x01\x01\x80\x80\x01\0", 10}), "Binary PokePaste has unknown flags");
+      CHECK_EQ(binary_error(std::string{"NGLP\x01\x02\0\0\0\0", 10}), "Binary PokePaste is truncated");
+      // Pokemon the text decoders would reject: flags, species, ability, then the fields flagged
+      CHECK_EQ(binary_error(std::string{"NGLP\x01\x01\x04\x01S\x01" "A\0", 12}), "Binary PokePaste has a female flag without a gender");
+      CHECK_EQ(binary_error(std::string{"NGLP\x01\x01\0\0\x01" "A\0", 11}), "Binary PokePaste has an empty field");
+      CHECK_EQ(binary_error(std::string{"NGLP\x01\x01\0\x01S\0\0", 11}), "Binary PokePaste has an empty field");
+      CHECK_EQ(binary_error(std::string{"NGLP\x01\x01\0\x01S\x01" "A\x01\0", 13}), "Binary PokePaste has an empty field");
+      CHECK_EQ(binary_error(std::string{"NGLP\x01\x01\x10\x01S\x01" "A\0\0", 13}), "Binary PokePaste has a value out of range");
+      CHECK_EQ(binary_error(std::string{"NGLP\x01\x01\x40\x01S\x01" "A\0\0", 13}), "Binary PokePaste has a value out of range");
+      CHECK_EQ(binary_error(std::string{"NGLP\x01\x01\x80\x01\x01S\x01" "A\0\0", 14}), "Binary PokePaste has a value out of range");
+      CHECK_EQ(binary_error(std::string{"NGLP\x01\x01\x10\x01S\x01" "A\x80\x80\x80\x80\x08\0", 17}), "Binary PokePaste has a value out of range");
+      CHECK_EQ(binary_error(std::string{"NGLP\x01\x01\x80\x04\x01S\x01" "A\0", 13}), "Binary PokePaste has an empty field");
+      CHECK_EQ(binary_error(std::string{"NGLP\x01\x01\0\x01S\x01" "A\0", 12}), "");
+      try {
+        (void)ngl::pokepaste::decode_binary_pokemon(repeated);
+        assert(false);
+      } catch (const std::runtime_error &e) {
+        CHECK_EQ(std::string_view{e.what()}, "Binary PokePaste must hold exactly one Pokemon");
+      }
+    }
+
+    {
+      // The packed form keeps every field the text form does, in Showdown's layout
+      ngl::pokepaste::Pokemon pokemon;
+      pokemon.nickname      = "Nickname";
+      pokemon.species       = "Species";
+      pokemon.gender        = ngl::pokepaste::Gender::F;
+      pokemon.item          = "Item";
+      pokemon.ability       = "Ability";
+      pokemon.level         = 50;
+      pokemon.shiny         = true;
+      pokemon.happiness     = 1;
+      pokemon.dynamax_level = 3;
+      pokemon.gigantamax    = true;
+      pokemon.tera_type     = "Type";
+      pokemon.evs           = {252, 0, 4, 0, 0, 252};
+      pokemon.nature        = "Nature";
+      pokemon.ivs           = {31, 0, 31, 31, 31, 0};
+      pokemon.moves         = {"Protect", "Hidden Power [Fire]", "Protect", "Move", "Protect"};
+      const auto packed     = ngl::pokepaste::encode_packed(pokemon);
+      CHECK_EQ(packed, "Nickname|Species|Item|Ability|Protect,Hidden Power Fire,Protect,Move,Protect|Nature|252,,4,,,252|F|,0,,,,0|S|50|1,,,G,3,Type");
+      CHECK_EQ(ngl::pokepaste::packed_size(pokemon), packed.size());
+      CHECK_EQ(ngl::pokepaste::decode_packed_pokemon(packed), pokemon);
+      CHECK_EQ(ngl::pokepaste::decode_packed(packed), ngl::pokepaste::PokePaste{pokemon});
+
+      const ngl::pokepaste::PokePaste team{pokemon, pokemon, pokemon};
+      const auto packed_team = ngl::pokepaste::encode_packed(team);
+      CHECK_EQ(packed_team, packed + "]" + packed + "]" + packed);
+      CHECK_EQ(ngl::pokepaste::decode_packed(packed_team), team);
+      assert((ngl::pokepaste::try_decode_packed(packed_team).ok()));
+      assert((ngl::pokepaste::encode_packed(ngl::pokepaste::PokePaste{}).empty()));
+      assert((ngl::pokepaste::decode_packed("").empty()));
+
+      ngl::pokepaste::Pokemon defaults;
+      defaults.species = "Species";
+      defaults.ability = "Ability";
+      defaults.level   = 100;
+      CHECK_EQ(ngl::pokepaste::encode_packed(defaults), "Species|||Ability|||||||100|");
+      CHECK_EQ(ngl::pokepaste::decode_packed_pokemon(ngl::pokepaste::encode_packed(defaults)), defaults);
+
+      // What Showdown itself writes, with IDs, a genderless N and a Poke Ball
+      const auto showdown = ngl::pokepaste::decode_packed("Rotom|rotomwash|choicescarf|levitate|voltswitch,hydropump|Timid|,,,252,4,252|N|,0,,,,|||,,pokeball,,,Water]Garchomp||lifeorb|roughskin|earthquake,hiddenpowerice|Jolly|,252,,,4,252|M||S||");
+      assert((showdown.size() == 2));
+      assert((showdown[0].nickname == "Rotom"));
+      CHECK_EQ(showdown[0].species, "rotomwash");
+      assert((!showdown[0].gender.has_value()));
+      assert((showdown[0].tera_type == "Water"));
+      CHECK_EQ(showdown[0].ivs.atk, 0);
+      CHECK_EQ(showdown[0].ivs.hp, 31);
+      assert((!showdown[1].nickname.has_value() && showdown[1].shiny && !showdown[1].level.has_value()));
+      CHECK_EQ(showdown[1].moves[1], "hiddenpowerice");
+
+      // Views keep the packed spelling of Hidden Power, as they cannot add the brackets
+      auto four_moves      = pokemon;
+      four_moves.moves     = {"Protect", "Hidden Power [Fire]", "Protect", "Move"};
+      const auto view_team = ngl::pokepaste::encode_packed(ngl::pokepaste::PokePaste{four_moves, four_moves});
+      const auto view      = ngl::pokepaste::decode_packed_view(view_team);
+      assert((view.size() == 2));
+      CHECK_EQ(view[1].species, "Species");
+      CHECK_EQ(view[1].move_list()[1], "Hidden Power Fire");
+
+      const auto packed_error = [](std::string_view malformed) {
+        const auto result = ngl::pokepaste::try_decode_packed(malformed);
+        assert((result.value.empty()));
+        return result.error.value_or(ngl::pokepaste::DecodeError{});
+      };
+      const auto unknown = packed_error("Species|||Ability|||||||||");
+      assert((unknown.code == ngl::pokepaste::DecodeErrc::MalformedPacked && unknown.line == 1 && unknown.column == 1));
+      const auto second = packed_error("Species|||Ability||||||||]Species|||Ability||||X||||");
+      assert((second.code == ngl::pokepaste::DecodeErrc::InvalidPackedGender && second.column == 48));
+      assert((packed_error("Species|||||||||||").code == ngl::pokepaste::DecodeErrc::MissingAbility));
+      assert((packed_error("|||Ability||||||||").code == ngl::pokepaste::DecodeErrc::MalformedName));
+      assert((packed_error("Species|||Ability|A,,B|||||||").code == ngl::pokepaste::DecodeErrc::EmptyMove));
+      assert((packed_error("Species|||Ability|||1,2,3|||||").code == ngl::pokepaste::DecodeErrc::MalformedPackedStats));
+      const auto stat = packed_error("Species|||Ability|||||,-1,,,,|||");
+      assert((stat.code == ngl::pokepaste::DecodeErrc::NegativeStat && stat.column == 24));
+      assert((packed_error("Species|||Ability||||||x||").code == ngl::pokepaste::DecodeErrc::InvalidPackedShiny));
+      assert((packed_error("Species|||Ability||||||||0").code == ngl::pokepaste::DecodeErrc::HappinessTooLow));
+      assert((packed_error("Species|||Ability|||||||abc|").code == ngl::pokepaste::DecodeErrc::MalformedInteger));
+      assert((packed_error("Species|||Ability||||||||,,,g").code == ngl::pokepaste::DecodeErrc::InvalidPackedGigantamax));
+      assert((packed_error("Species|||Ability||||||||,,,,0").code == ngl::pokepaste::DecodeErrc::DynamaxLevelTooLow));
+      assert((packed_error("Species|||Ability||||||||,,,,,,").code == ngl::pokepaste::DecodeErrc::MalformedPacked));
+      assert((packed_error("Species|||Ability||||||||]").code == ngl::pokepaste::DecodeErrc::MalformedPacked));
+
+      try {
+        (void)ngl::pokepaste::decode_packed("Species|||Ability|||||||0|");
+        assert(false);
+      } catch (const std::runtime_error &e) {
+        CHECK_EQ(std::string_view{e.what()}, "Pokemon Level cannot be less than 0");
+      }
+      try {
+        (void)ngl::pokepaste::decode_packed_view("Species|||Ability|A,B,C,D,E|||||||");
+        assert(false);
+      } catch (const ngl::pokepaste::domain_bound_error &) {
+      }
+      for (const auto &[field, text] : {std::pair{&ngl::pokepaste::Pokemon::species, "Spe|cies"}, std::pair{&ngl::pokepaste::Pokemon::ability, "Abil]ity"}}) {
+        auto bad   = defaults;
+        bad.*field = text;
+        try {
+          (void)ngl::pokepaste::encode_packed(bad);
+          assert(false);
+        } catch (const ngl::pokepaste::domain_bound_error &) {
+        }
+      }
+      auto comma_move = defaults;
+      comma_move.moves.emplace_back("Move, Again");
+      try {
+        (void)ngl::pokepaste::encode_packed(comma_move);
+        assert(false);
+      } catch (const ngl::pokepaste::domain_bound_error &) {
+      }
+
+      ngl::pokepaste::PackedTeamReader reader{view_team};
+      for (std::size_t i = 0; i < view.size(); i++) {
+        const auto next = reader.next();
+        assert((next.has_value() && next->nickname == "Nickname"));
+      }
+      assert((!reader.next().has_value()));
+      assert((!ngl::pokepaste::PackedTeamReader{""}.next().has_value()));
+
+      // Pokemon wholly within a chunk are decoded from it, the rest from what was buffered
+      std::vector<std::string> streamed;
+      ngl::pokepaste::PackedStreamDecoder decoder{[&](ngl::pokepaste::Pokemon decoded) {
+        streamed.push_back(std::move(decoded.species));
+      }};
+      decoder.feed("A|||Ability||||||||]B|||Abil");
+      assert((streamed.size() == 1));
+      decoder.feed("ity||||||||]C|||Ability||||||||]");
+      assert((streamed.size() == 3));
+      decoder.feed("D|||Ability||||||||");
+      decoder.finish();
+      assert((streamed == std::vector<std::string>{"A", "B", "C", "D"}));
+      decoder.finish();
+      assert((streamed.size() == 4));
+      try {
+        decoder.feed("E|||Ability||||||||]F|||");
+        decoder.finish();
+        assert(false);
+      } catch (const std::runtime_error &e) {
+        CHECK_EQ(std::string_view{e.what()}, ngl::pokepaste::decode_error_message(ngl::pokepaste::DecodeErrc::MalformedPacked));
+      }
+      decoder.feed("G|||Ability||||||||");
+      decoder.finish();
+      CHECK_EQ(streamed.back(), "G");
+
+      // Streamed Pokemon are the ones decode_packed gives, however the team is split, including more
+      // than 4 moves and Hidden Power's brackets
+      for (const auto chunk_size : {std::size_t{1}, std::size_t{5}, packed_team.size()}) {
+        ngl::pokepaste::PokePaste streamed_team;
+        ngl::pokepaste::PackedStreamDecoder team_decoder{[&](ngl::pokepaste::Pokemon decoded) {
+          streamed_team.push_back(std::move(decoded));
+        }};
+        for (std::size_t i = 0; i < packed_team.size(); i += chunk_size) {
+          team_decoder.feed(std::string_view{packed_team}.substr(i, chunk_size));
+        }
+        team_decoder.finish();
+        CHECK_EQ(streamed_team, ngl::pokepaste::decode_packed(packed_team));
+      }
+    }
+
+    {
+      ngl::pokepaste::PokePaste streamed;
+      ngl::pokepaste::PokePasteStreamDecoder decoder{[&](ngl::pokepaste::Pokemon pokemon) {
+        streamed.push_back(std::move(pokemon));
+      }};
+      decoder.feed("\r\n\nSpecies\r\nAbility: Abil");
+      decoder.feed("ity\r");
+      assert((streamed.empty()));
+      decoder.feed("\n\r");
+      assert((streamed.empty()));
+      decoder.feed("\nOther Species\nAbility: Ability");
+      assert((streamed.size() == 1));
+      assert((streamed.front().ability == "Ability"));
+      decoder.finish();
+      assert((streamed.size() == 2));
+      assert((streamed.back().species == "Other Species"));
+    }
+
+    {
+      const auto pokemon_value = std::string{
+        "Species\n"
+        "Ability: Ability\n"
+        "   \n"
+        "- Attack 1\n"
+      };
+
+      try {
+        (void)ngl::pokepaste::decode_pokemon(pokemon_value);
+        assert(false);
+      } catch ([[maybe_unused]] const std::runtime_error &e) { // NOLINT
+      }
+    }
   }
 
   // "Integration" tests
@@ -783,7 +1819,226 @@ auto main(int argc, const char **argv) -> int {
       const auto paste         = ngl::pokepaste::decode_pokepaste(content);
       const auto paste_encoded = ngl::pokepaste::encode_pokepaste(paste);
 
+      {
+        // Anything not taken from the arena would fail against the null default resource
+        std::pmr::monotonic_buffer_resource arena;
+        auto *const previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+        const auto pmr_paste = ngl::pokepaste::decode_pokepaste(content, &arena);
+        std::pmr::set_default_resource(previous);
+        CHECK_EQ(pmr_paste.size(), paste.size());
+        CHECK_EQ(ngl::pokepaste::encode_pokepaste(pmr_paste), paste_encoded);
+        assert((pmr_paste.get_allocator().resource() == &arena));
+        for (const auto &pokemon : pmr_paste) {
+          assert((pokemon.get_allocator().resource() == &arena));
+        }
+      }
+
+      const auto try_paste = ngl::pokepaste::try_decode_pokepaste(content);
+      const auto recovered = ngl::pokepaste::decode_pokepaste_recovering(content);
+      assert((try_paste.ok() && recovered.ok()));
+      CHECK_EQ(try_paste.value, paste);
+      CHECK_EQ(recovered.pokemon, paste);
+
       CHECK_EQ(content, paste_encoded);
+
+      const auto paste_binary = ngl::pokepaste::encode_binary(paste);
+      CHECK_EQ(ngl::pokepaste::decode_binary(paste_binary), paste);
+      assert((paste_binary.size() < content.size()));
+
+      const auto paste_packed = ngl::pokepaste::encode_packed(paste);
+      CHECK_EQ(ngl::pokepaste::decode_packed(paste_packed), paste);
+      assert((paste_packed.size() < content.size()));
+      for (const auto chunk_size : {std::size_t{1}, std::size_t{7}, std::size_t{64}}) {
+        ngl::pokepaste::PokePaste streamed;
+        ngl::pokepaste::PackedStreamDecoder decoder{[&](ngl::pokepaste::Pokemon pokemon) {
+          streamed.push_back(std::move(pokemon));
+        }};
+        for (std::size_t i = 0; i < paste_packed.size(); i += chunk_size) {
+          decoder.feed(std::string_view{paste_packed}.substr(i, chunk_size));
+          assert((streamed.size() <= paste.size()));
+        }
+        decoder.finish();
+        CHECK_EQ(streamed, paste);
+      }
+
+      std::string reused{"\n\n"};
+      ngl::pokepaste::encode_pokepaste_to(reused, paste);
+      CHECK_EQ(reused, "\n\n" + content);
+
+      CHECK_EQ(paste_encoded, golden::encode_pokepaste(paste));
+      for (const auto &pokemon : paste) {
+        CHECK_EQ(ngl::pokepaste::encode_pokemon(pokemon), golden::encode_pokemon(pokemon));
+      }
+      assert((ngl::pokepaste::encoded_size(paste) == content.size()));
+      std::string exact;
+      exact.reserve(ngl::pokepaste::encoded_size(paste));
+      const auto capacity = exact.capacity();
+      ngl::pokepaste::encode_pokepaste_to(exact, paste);
+      assert((exact.capacity() == capacity));
+
+      const auto paste_view = ngl::pokepaste::decode_pokepaste_view(content);
+      CHECK_EQ(ngl::pokepaste::to_owned(paste_view), paste);
+
+      CHECK_EQ(ngl::pokepaste::decode_pokepaste_file(paste_file.path()), paste);
+
+      const auto paste_compact = ngl::pokepaste::decode_pokepaste_compact(content);
+      assert((paste_compact == ngl::pokepaste::to_compact(paste)));
+      CHECK_EQ(ngl::pokepaste::to_owned(paste_compact), paste);
+      CHECK_EQ(ngl::pokepaste::encode_pokepaste(paste_compact), content);
+
+      for (const auto scanner : {ngl::pokepaste::LineScanner::Scalar, ngl::pokepaste::LineScanner::SSE2, ngl::pokepaste::LineScanner::AVX2}) {
+        if (ngl::pokepaste::line_scanner_supported(scanner)) {
+          ngl::pokepaste::set_line_scanner(scanner);
+          CHECK_EQ(ngl::pokepaste::decode_pokepaste(content), paste);
+        }
+      }
+      ngl::pokepaste::set_line_scanner(ngl::pokepaste::LineScanner::Auto);
+
+      // Stream the paste with CRLFs in chunk sizes that split lines and line endings everywhere
+      std::string crlf_content;
+      for (const auto c : content) {
+        if (c == '\n') {
+          crlf_content.push_back('\r');
+        }
+        crlf_content.push_back(c);
+      }
+      for (const auto chunk_size : {std::size_t{1}, std::size_t{7}, std::size_t{64}}) {
+        ngl::pokepaste::PokePaste streamed;
+        ngl::pokepaste::PokePasteStreamDecoder decoder{[&](ngl::pokepaste::Pokemon pokemon) {
+          streamed.push_back(std::move(pokemon));
+        }};
+        for (std::size_t i = 0; i < crlf_content.size(); i += chunk_size) {
+          decoder.feed(std::string_view{crlf_content}.substr(i, chunk_size));
+          assert((streamed.size() <= paste.size()));
+        }
+        decoder.finish();
+        CHECK_EQ(streamed, paste);
+      }
+    }
+
+    const auto corpus = ngl::pokepaste::decode_pokepaste_directory("resources");
+    assert((corpus.size() == 11));
+    for (const auto &[path, paste] : corpus) {
+      assert((path.extension() == ".paste"));
+      CHECK_EQ(paste, ngl::pokepaste::decode_pokepaste_file(path));
+    }
+
+    // Decoding every paste into the same objects leaves nothing over from the ones before
+    ngl::pokepaste::PokePaste reused_paste;
+    ngl::pokepaste::Pokemon reused_pokemon;
+    for (const auto &[path, paste] : corpus) {
+      ngl::pokepaste::decode_pokepaste_into(ngl::pokepaste::encode_pokepaste(paste), reused_paste);
+      CHECK_EQ(reused_paste, paste);
+      for (const auto &pokemon : paste) {
+        ngl::pokepaste::decode_pokemon_into(ngl::pokepaste::encode_pokemon(pokemon), reused_pokemon);
+        CHECK_EQ(reused_pokemon, pokemon);
+      }
+    }
+
+    std::vector<std::string> batch_content;
+    for (const auto &[path, paste] : corpus) {
+      batch_content.push_back(ngl::pokepaste::encode_pokepaste(paste));
+      batch_content.emplace_back("Species\nAbility: Ability\nLevel: -1");
+    }
+    const auto batch = std::vector<std::string_view>(batch_content.begin(), batch_content.end());
+    for (const auto thread_count : {std::size_t{0}, std::size_t{1}, std::size_t{3}, std::size_t{64}}) {
+      const auto results = ngl::pokepaste::decode_many(batch, thread_count);
+      assert((results.size() == batch.size()));
+      for (std::size_t i = 0; i < results.size(); i++) {
+        if (i % 2 == 0) {
+          assert((results[i].ok()));
+          CHECK_EQ(results[i].paste, corpus[i / 2].paste);
+        } else {
+          assert((!results[i].ok()));
+        }
+      }
+    }
+
+    // Every paste shares one table, filled from several threads at once
+    ngl::pokepaste::SymbolTable symbols;
+    std::vector<ngl::pokepaste::InternedPokePaste> interned(corpus.size());
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < corpus.size(); i++) {
+      threads.emplace_back([&, i] {
+        interned[i] = ngl::pokepaste::decode_pokepaste_interned(batch[i * 2], symbols);
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    for (std::size_t i = 0; i < corpus.size(); i++) {
+      CHECK_EQ(ngl::pokepaste::to_owned(interned[i], symbols), corpus[i].paste);
+      for (const auto &pokemon : corpus[i].paste) {
+        assert((ngl::pokepaste::intern(pokemon, symbols).species == symbols.find(pokemon.species)));
+      }
     }
   }
-}
\ No newline at end of file
+
+  // Stress tests over generated pastes, which are reproducible from the seed
+  {
+    ngl::pokepaste::synthetic::Options options;
+    options.seed           = 20240501;
+    options.min_moves      = 0;
+    options.max_moves      = 6;
+    options.crlf_rate      = 0.3;
+    options.malformed_rate = 0.2;
+    ngl::pokepaste::synthetic::Generator generator{options};
+    ngl::pokepaste::synthetic::Generator same_seed{options};
+    assert((generator.paste().text == same_seed.paste().text));
+
+    std::string joined_text;
+    ngl::pokepaste::PokePaste joined_pokemon;
+    std::size_t joined_blocks = 0;
+    std::vector<std::size_t> joined_malformed;
+    const auto invalid_options = [&](auto edit) {
+      auto invalid = options;
+      edit(invalid);
+      try {
+        (void)ngl::pokepaste::synthetic::Generator{invalid};
+      } catch ([[maybe_unused]] const std::invalid_argument &e) { // NOLINT
+        return true;
+      }
+      return false;
+    };
+    assert((invalid_options([](auto &invalid) { invalid.min_pokemon = 7; })));
+    assert((invalid_options([](auto &invalid) { invalid.max_moves = std::numeric_limits<std::size_t>::max(); })));
+    assert((invalid_options([](auto &invalid) { invalid.min_pokemon = invalid.max_pokemon = 0; })));
+
+    // A paste may be empty, which leaves no Pokemon to malform
+    auto maybe_empty           = options;
+    maybe_empty.min_pokemon    = 0;
+    maybe_empty.max_pokemon    = 1;
+    maybe_empty.malformed_rate = 1.0;
+    ngl::pokepaste::synthetic::Generator empty_generator{maybe_empty};
+    for (std::size_t i = 0; i < 20; i++) {
+      const auto generated = empty_generator.paste();
+      assert((generated.text.empty() != generated.malformed.has_value()));
+    }
+
+    for (const auto &generated : generator.corpus(std::size_t{1} << 20U)) {
+      if (generated.malformed.has_value()) {
+        const auto result = ngl::pokepaste::decode_pokepaste_recovering(generated.text);
+        assert((result.errors.size() == 1 && result.errors.front().block == generated.malformed.value()));
+        CHECK_EQ(result.pokemon, generated.pokemon);
+        joined_malformed.push_back(joined_blocks + generated.malformed.value());
+      } else {
+        const auto paste = ngl::pokepaste::decode_pokepaste(generated.text);
+        CHECK_EQ(paste, generated.pokemon);
+        CHECK_EQ(ngl::pokepaste::decode_pokepaste(ngl::pokepaste::encode_pokepaste(paste)), paste);
+        CHECK_EQ(ngl::pokepaste::decode_binary(ngl::pokepaste::encode_binary(paste)), paste);
+        CHECK_EQ(ngl::pokepaste::decode_packed(ngl::pokepaste::encode_packed(paste)), paste);
+      }
+      joined_text.append(joined_text.empty() ? "" : "\n\n").append(generated.text);
+      joined_pokemon.insert(joined_pokemon.end(), generated.pokemon.begin(), generated.pokemon.end());
+      joined_blocks += generated.pokemon.size() + (generated.malformed.has_value() ? 1 : 0);
+    }
+
+    // The same pastes decoded as one large paste
+    const auto joined = ngl::pokepaste::decode_pokepaste_recovering(joined_text);
+    CHECK_EQ(joined.pokemon, joined_pokemon);
+    assert((joined.errors.size() == joined_malformed.size()));
+    for (std::size_t i = 0; i < joined_malformed.size(); i++) {
+      assert((joined.errors[i].block == joined_malformed[i]));
+    }
+  }
+}